@@ -78,6 +78,7 @@
 #include "UI/UIGlobals.h"
 #include "UI/TabWindow.h"
 #include "UI/HierarchyWindow.h"
+#include "UI/HierarchyList.h"
 
 #include "../Resource/XMLFile.h"
 #include "UI/AttributeInspector.h"
@@ -120,6 +121,7 @@ namespace Urho3D
 		MenuBarUI::RegisterObject(context_);
 		ToolBarUI::RegisterObject(context_);
 		MiniToolBarUI::RegisterObject(context_);
+		HierarchyList::RegisterObject(context_);
 
 		TemplateManager::RegisterObject(context_);
 		TabWindow::RegisterObject(context_);
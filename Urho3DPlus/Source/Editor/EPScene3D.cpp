@@ -4,6 +4,7 @@
 #include "../Scene/Component.h"
 #include "../Scene/Node.h"
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 #include "../UI/Window.h"
 #include "EditorData.h"
 #include "../UI/Text.h"
@@ -66,6 +67,17 @@
 #include "GizmoScene3D.h"
 #include "../Physics/RigidBody.h"
 #include "../UI/ListView.h"
+#include "../UI/HierarchyList.h"
+#include "EditorPicking.h"
+#include "AttributeVariableEvents.h"
+#include "EditorProfiler.h"
+#include "SceneSnapshot.h"
+#include "SceneSaver.h"
+#include "SceneJournal.h"
+#include "ResourceRetention.h"
+#include "../Graphics/OctreeQuery.h"
+#include "../Math/Frustum.h"
+#include "../Container/HashSet.h"
 
 
 namespace Urho3D
@@ -103,9 +115,61 @@ namespace Urho3D
 		"Point"
 	};
 
+	/// Drag distance in pixels before a left click becomes a marquee selection.
+	const int MARQUEE_MIN_SIZE = 4;
+	/// Width in pixels of the scene load progress bar.
+	const int LOAD_PROGRESS_WIDTH = 200;
+	/// Seconds between stats overlay refreshes.
+	const float STATS_REFRESH_INTERVAL = 0.25f;
+	/// Gap in pixels between view panes.
+	const int VIEW_PANE_SPACING = 2;
+	/// Inactive pane redraw intervals cycled from the menu, 0 redraws them on every change.
+	const float INACTIVE_VIEW_UPDATE_INTERVALS[] = { 0.0f, 0.1f, 0.25f, 1.0f };
+	const unsigned NUM_INACTIVE_VIEW_UPDATE_INTERVALS = sizeof(INACTIVE_VIEW_UPDATE_INTERVALS) / sizeof(INACTIVE_VIEW_UPDATE_INTERVALS[0]);
+	/// Orthographic pane camera distance from the origin and initial ortho size.
+	const float ORTHO_VIEW_DISTANCE = 100.0f;
+	const float ORTHO_VIEW_SIZE = 20.0f;
+	/// Lowest render resolution scale while the camera moves.
+	const float MIN_RENDER_SCALE = 0.25f;
+	/// Render scale quantization steps.
+	const float RENDER_SCALE_STEPS = 16.0f;
+	/// Time without camera movement before returning to full resolution.
+	const float RENDER_SCALE_SETTLE_TIME = 0.2f;
+	/// Render target sizes are rounded up to this many pixels, so small resizes reuse the textures.
+	const int RENDER_TARGET_BUCKET = 64;
+	/// Time without resizes before the render target is reallocated.
+	const float RESIZE_SETTLE_TIME = 0.15f;
+	/// Grid lines per direction; the vertex count stays fixed however far the view reaches.
+	const unsigned GRID_CELLS = 64;
+	/// Minor lines per major line, also the factor between cell size levels.
+	const unsigned GRID_SUBDIVISIONS = 8;
+	/// Smallest and largest grid cell size in world units.
+	const float GRID_MIN_CELL_SIZE = 1.0f;
+	const float GRID_MAX_CELL_SIZE = 262144.0f;
+	/// Grid half extent in multiples of the camera distance from the grid plane.
+	const float GRID_VIEW_RANGE = 4.0f;
+	/// Microseconds per frame spent on detailed selection debug geometry before components fall back to bounding boxes.
+	const long long DEBUG_DRAW_TIME_BUDGET = 2000;
+	/// Bounding boxes drawn per frame for the selection at most.
+	const unsigned DEBUG_DRAW_MAX_BOXES = 4096;
+	/// Depth below a selected node from which whole subtrees are drawn as one box.
+	const unsigned DEBUG_DETAIL_DEPTH = 3;
+	/// Components smaller than this fraction of their camera distance are drawn as their box.
+	const float DEBUG_DETAIL_MIN_SIZE = 0.01f;
+	/// Color of the boxes standing in for detailed debug geometry.
+	const Color DEBUG_LOD_COLOR(0.5f, 0.5f, 0.5f);
+
+	/// View directions of the orthographic panes: top, front, side.
+	const Vector3 viewPaneDirections[] = {
+		Vector3(0.0f, -1.0f, 0.0f),
+		Vector3(0.0f, 0.0f, 1.0f),
+		Vector3(-1.0f, 0.0f, 0.0f)
+	};
+
 	EPScene3D::EPScene3D(Context* context) : EditorPlugin(context),
 		showGrid_(true),
 		grid2DMode_(false),
+		gridGeometryHash_(0),
 		sceneModified(false)
 	{
 		ui_ = GetSubsystem<UI>();
@@ -201,6 +265,7 @@ namespace Urho3D
 					
 			if (visible)
 			{
+				SubscribeToEvent(E_POSTUPDATE, HANDLER(EPScene3D, HandlePostUpdate));
 				SubscribeToEvent(E_POSTRENDERUPDATE, HANDLER(EPScene3D, HandlePostRenderUpdate));
 				SubscribeToEvent(E_UIMOUSECLICK, HANDLER(EPScene3D, ViewMouseClick));
 				SubscribeToEvent(E_MOUSEMOVE, HANDLER(EPScene3D, ViewMouseMove));
@@ -213,6 +278,7 @@ namespace Urho3D
 			}
 			else
 			{
+				UnsubscribeFromEvent(E_POSTUPDATE);
 				UnsubscribeFromEvent(E_POSTRENDERUPDATE);
 				UnsubscribeFromEvent(E_UIMOUSECLICK);
 				UnsubscribeFromEvent(E_MOUSEMOVE);
@@ -230,13 +296,29 @@ namespace Urho3D
 	{
 		UpdateStats(timeStep);
 
-		if (runUpdate)
+		// Scene updates are disabled, so an asynchronous load is advanced here. Scene::Update() only loads while loading
+		if (runUpdate || IsLoadingScene())
+		{
+			ScopedStageTimer timer(this, STAGE_SCENEUPDATE);
 			editorData_->GetEditorScene()->Update(timeStep);
+		}
 
 		if (toolBarDirty && editorView_->IsToolBarVisible())
+		{
 			UpdateToolBar();
+			QueueViewUpdates();
+		}
+
+		{
+			ScopedStageTimer timer(this, STAGE_GIZMO);
+			gizmo_->UpdateGizmo();
+		}
+		UpdateMarquee();
 
-		gizmo_->UpdateGizmo();
+		// Redraw only when the simulation runs, the gizmo changed or the pickable scene content changed
+		if (runUpdate || gizmo_->IsChanged() || picking_->GetModificationCount() != viewModificationCount)
+			QueueViewUpdates();
+		viewModificationCount = picking_->GetModificationCount();
 
 		if (ui_->HasModalElement() || ui_->GetFocusElement() != NULL)
 		{
@@ -384,23 +466,23 @@ namespace Urho3D
 
 	void EPScene3D::ResetCamera()
 	{
-		//for (uint i = 0; i < viewports.length; ++i)
-		activeView->ResetCamera();
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+			ResetViewCamera(i);
 	}
 
 	void EPScene3D::ReacquireCameraYawPitch()
 	{
-		//for (uint i = 0; i < viewports.length; ++i)
-		activeView->ReacquireCameraYawPitch();
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+			views_[i]->ReacquireCameraYawPitch();
 	}
 
 	void EPScene3D::UpdateViewParameters()
 	{
-		//for (uint i = 0; i < viewports.length; ++i)
+		for (unsigned int i = 0; i < views_.Size(); ++i)
 		{
-			activeView->camera_->SetNearClip(viewNearClip);
-			activeView->camera_->SetFarClip(viewFarClip);
-			activeView->camera_->SetFov(viewFov);
+			views_[i]->camera_->SetNearClip(viewNearClip);
+			views_[i]->camera_->SetFarClip(viewFarClip);
+			views_[i]->camera_->SetFov(viewFov);
 		}
 	}
 
@@ -417,6 +499,7 @@ namespace Urho3D
 		{
 			SetupStatsBarText(editorModeText, font, 35, 64, HA_LEFT, VA_TOP);
 			SetupStatsBarText(renderStatsText, font, -4, 64, HA_RIGHT, VA_TOP);
+			renderStatsText->SetTextAlignment(HA_RIGHT);
 		}
 		else
 		{
@@ -438,6 +521,20 @@ namespace Urho3D
 
 	void EPScene3D::UpdateStats(float timeStep)
 	{
+		// Hover pick cache hit rate over the last window of picks
+		if (hoverPickQueries >= 120)
+		{
+			hoverPickHitRate = (float)hoverPickHits / (float)hoverPickQueries;
+			hoverPickHits = 0;
+			hoverPickQueries = 0;
+		}
+
+		// Rebuilding the texts is not free, refresh them at a fixed low rate
+		statsTimer += timeStep;
+		if (statsTimer < STATS_REFRESH_INTERVAL)
+			return;
+		statsTimer = 0.0f;
+
 		editorModeText->SetText(String(
 			"Mode: " + editModeText[editMode] +
 			"  Axis: " + axisModeText[axisMode] +
@@ -445,12 +542,32 @@ namespace Urho3D
 			"  Fill: " + fillModeText[fillMode] +
 			"  Updates: " + (runUpdate ? "Running" : "Paused")));
 
-		renderStatsText->SetText(String(
+		String stats(
 			"Tris: " + String(renderer->GetNumPrimitives()) +
 			"  Batches: " + String(renderer->GetNumBatches()) +
 			"  Lights: " + String(renderer->GetNumLights(true)) +
 			"  Shadowmaps: " + String(renderer->GetNumShadowMaps(true)) +
-			"  Occluders: " + String(renderer->GetNumOccluders(true))));
+			"  Occluders: " + String(renderer->GetNumOccluders(true)) +
+			"  Pick cache: " + String((int)(hoverPickHitRate * 100.0f)) + "%" +
+			(renderOnDemand ? "  Skipped frames: " + String(activeView->GetNumSkippedFrames()) + "/" + String(activeView->GetNumFrames()) : String::EMPTY) +
+			(viewportLayout != VIEWPORT_SINGLE ? "  Other views: " + (inactiveViewUpdateInterval > 0.0f ? String(inactiveViewUpdateInterval) + " s" : String("on change")) : String::EMPTY) +
+			(selectionDebugDetailed || selectionDebugBoxes ? "  Debug: " + String(selectionDebugDetailed) + " full, " + String(selectionDebugBoxes) + " boxes" : String::EMPTY) +
+			(activeView->GetRenderScale() < 1.0f ? "  Scale: " + String((int)(activeView->GetRenderScale() * 100.0f)) + "%" : String::EMPTY));
+
+		EditorProfiler* profiler = GetSubsystem<EditorProfiler>();
+		if (profiler)
+		{
+			profiler->UpdateStatistics();
+			stats += ToString("\nFrame ms  p50: %.2f  p95: %.2f  p99: %.2f", profiler->GetFrameTimeP50(), profiler->GetFrameTimeP95(),
+				profiler->GetFrameTimeP99());
+			stats += "\n";
+			for (unsigned int i = 0; i < MAX_EDITOR_STAGES; ++i)
+			{
+				EditorStage stage = (EditorStage)i;
+				stats += (i ? "  " : "") + EditorProfiler::GetStageName(stage) + ToString(": %.2f", profiler->GetStageAverage(stage));
+			}
+		}
+		renderStatsText->SetText(stats);
 
 		editorModeText->SetSize(editorModeText->GetMinSize());
 		renderStatsText->SetSize(renderStatsText->GetMinSize());
@@ -459,9 +576,8 @@ namespace Urho3D
 	void EPScene3D::SetFillMode(FillMode fM_)
 	{
 		fillMode = fM_;
-// 		for (uint i = 0; i < viewports.length; ++i)
-// 			viewports[i].camera.fillMode = fillMode_;
-		camera_->SetFillMode(fM_);
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+			views_[i]->camera_->SetFillMode(fM_);
 	}
 
 	void EPScene3D::Start()
@@ -470,19 +586,42 @@ namespace Urho3D
 		window_ = new UIElement(context_);
 		window_->SetDefaultStyle(editorData_->GetDefaultStyle());
 
-		activeView = window_->CreateChild<EPScene3DView>("Scene3DView");
-		activeView->SetDefaultStyle(editorData_->GetDefaultStyle());
-		activeView->SetView(editorData_->GetEditorScene());
-		activeView->CreateViewportContextUI(editorData_->GetDefaultStyle(), editorData_->GetIconStyle());
-		cameraNode_ = activeView->GetCameraNode();
-		camera_ = activeView->GetCamera();
-		activeView->SetAutoUpdate(true);
+		SetActiveView(CreateView());
+		ResetViewCamera(0);
 
 		CreateGrid();
 		ShowGrid();
 		CreateStatsBar();
 
+		picking_ = new EditorPicking(context_, editorData_->GetEditorScene());
+
+		// Autosave files are removed on a clean shutdown, finding them means the last session crashed
+		String autosavePath = fileSystem_->GetProgramDir() + "Autosave";
+		fileSystem_->CreateDir(autosavePath);
+		autosaveJournal = new SceneJournal(context_, autosavePath);
+		autosaveJournal->SetInterval(autosaveInterval);
+		if (autosaveJournal->HasRecovery())
+		{
+			SharedPtr<MessageBox> messageBox(new MessageBox(context_, "The editor did not shut down properly.\nRestore the autosaved scene?", "Autosave"));
+			messageBox->AddRef();
+			if (messageBox->GetWindow() != NULL)
+			{
+				Button* cancelButton = (Button*)messageBox->GetWindow()->GetChild("CancelButton", true);
+				cancelButton->SetVisible(true);
+				SubscribeToEvent(messageBox, E_MESSAGEACK, HANDLER(EPScene3D, HandleAutosaveRecovery));
+			}
+		}
+		else
+			autosaveJournal->Track(editorData_->GetEditorScene());
+
 		SubscribeToEvent(window_, E_RESIZED, HANDLER(EPScene3D, HandleResizeView));
+		// Selection and attribute changes alter the debug geometry and the scene without moving anything the picking tracks
+		SubscribeToEvent(editor_->GetHierarchyWindow()->GetHierarchyList(), E_SELECTIONCHANGED, HANDLER(EPScene3D, HandleViewChanged));
+		SubscribeToEvent(AEE_BOOLVARCHANGED, HANDLER(EPScene3D, HandleViewChanged));
+		SubscribeToEvent(AEE_STRINGVARCHANGED, HANDLER(EPScene3D, HandleViewChanged));
+		SubscribeToEvent(AEE_NUMBERVARCHANGED, HANDLER(EPScene3D, HandleViewChanged));
+		SubscribeToEvent(AEE_ENUMVARCHANGED, HANDLER(EPScene3D, HandleViewChanged));
+		SubscribeToEvent(AEE_RESREFVARCHANGED, HANDLER(EPScene3D, HandleViewChanged));
 
 		//////////////////////////////////////////////////////////////////////////
 		/// Menu Bar entries
@@ -496,6 +635,16 @@ namespace Urho3D
 		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Load node as replicated", A_LOADNODEASREP_VAR);
 		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Load node as local", A_LOADNODEASLOCAL_VAR);
 		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Save node as", A_SAVENODEAS_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Benchmark picking", A_BENCHMARKPICKING_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Benchmark hierarchy", A_BENCHMARKHIERARCHY_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Export frame times", A_EXPORTFRAMETIMES_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Toggle render on demand", A_RENDERONDEMAND_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Toggle adaptive resolution", A_DYNAMICRESOLUTION_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Toggle gizmo drag preview", A_GIZMOPREVIEW_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Single viewport", A_VIEWLAYOUTSINGLE_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Two viewports", A_VIEWLAYOUTSPLIT_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Four viewports", A_VIEWLAYOUTQUAD_VAR);
+		editorView_->GetGetMenuBar()->CreateMenuItem("Scene", "Cycle other viewports rate", A_INACTIVEVIEWRATE_VAR);
 
 		createMenu_ = editorView_->GetGetMenuBar()->CreateMenu("Create");
 
@@ -775,89 +924,144 @@ namespace Urho3D
 
 	Urho3D::Vector3 EPScene3D::SelectedNodesCenterPoint()
 	{
-		Vector3 centerPoint;
-		unsigned int count = editorSelection_->GetNumSelectedNodes();
+		return editorSelection_->GetSelectionCenter();
+	}
+
+	void EPScene3D::DrawSelectionDebug(DebugRenderer* debug)
+	{
+		// Collected items and their boxes stay valid until the selection or the scene changes
+		unsigned modificationCount = picking_->GetModificationCount();
+		if (selectionDebugDirty || runUpdate || modificationCount != selectionDebugModificationCount)
+		{
+			selectionDebugItems.Clear();
+			for (unsigned int i = 0; i < editorSelection_->GetNumSelectedNodes(); ++i)
+				CollectNodeDebug(editorSelection_->GetSelectedNodes()[i], 0);
+			selectionDebugDirty = false;
+			selectionDebugModificationCount = modificationCount;
+		}
+
+		// To avoid cluttering the view, only the selected nodes get their axes drawn
 		for (unsigned int i = 0; i < editorSelection_->GetNumSelectedNodes(); ++i)
-			centerPoint += editorSelection_->GetSelectedNodes()[i]->GetWorldPosition();
+			debug->AddNode(editorSelection_->GetSelectedNodes()[i], 1.0f, false);
+
+		Frustum frustum = camera_->GetFrustum();
+		Vector3 cameraPos = cameraNode_->GetWorldPosition();
+		float orthoSize = camera_->IsOrthographic() ? camera_->GetOrthoSize() / camera_->GetZoom() : 0.0f;
+		unsigned numDetailed = 0;
+		unsigned numBoxes = 0;
+		HiresTimer timer;
 
-		for (unsigned int i = 0; i < editorSelection_->GetNumSelectedComponents(); ++i)
+		for (unsigned int i = 0; i < selectionDebugItems.Size(); ++i)
 		{
-			Drawable* drawable = dynamic_cast<Drawable*>(editorSelection_->GetSelectedComponents()[i]);
-			count++;
-			if (drawable != NULL)
-				centerPoint += drawable->GetNode()->LocalToWorld(drawable->GetBoundingBox().Center());
-			else
-				centerPoint += editorSelection_->GetSelectedComponents()[i]->GetNode()->GetWorldPosition();
+			const SelectionDebugItem& item = selectionDebugItems[i];
+			Component* component = item.component_;
+			bool hasBox = item.box_.Defined();
+			if ((!item.subtree_ && !component) || (hasBox && frustum.IsInsideFast(item.box_) == OUTSIDE))
+				continue;
+
+			// Distant and small components are drawn as their box
+			bool detail = !item.subtree_;
+			if (detail && hasBox)
+			{
+				float distance = orthoSize > 0.0f ? orthoSize : (item.box_.Center() - cameraPos).Length();
+				detail = item.box_.Size().Length() >= distance * DEBUG_DETAIL_MIN_SIZE;
+			}
+
+			// Full geometry goes straight to the view's debug renderer, so components can cull against it, until the time is used up
+			if (detail && timer.GetUSec(false) < DEBUG_DRAW_TIME_BUDGET)
+			{
+				component->DrawDebugGeometry(debug, false);
+				++numDetailed;
+				continue;
+			}
+
+			// Over budget components without a box are skipped
+			if (!hasBox)
+				continue;
+			if (numBoxes >= DEBUG_DRAW_MAX_BOXES)
+				break;
+			debug->AddBoundingBox(item.box_, DEBUG_LOD_COLOR, false);
+			++numBoxes;
 		}
 
-		if (count > 0)
-			return centerPoint / float(count);
-		else
-			return centerPoint;
+		selectionDebugDetailed = numDetailed;
+		selectionDebugBoxes = numBoxes;
 	}
 
-	void EPScene3D::DrawNodeDebug(Node* node, DebugRenderer* debug, bool drawNode /*= true*/)
+	void EPScene3D::CollectNodeDebug(Node* node, unsigned depth)
 	{
-		if (drawNode)
-			debug->AddNode(node, 1.0f, false);
-
 		// Exception for the scene to avoid bringing the editor to its knees: drawing either the whole hierarchy or the subsystem-
 		// components can have a large performance hit. Also do not draw terrain child nodes due to their large amount
 		// (TerrainPatch component itself draws nothing as debug geometry)
-		if (node != editorData_->GetEditorScene() && node->GetComponent<Terrain>() == NULL)
+		if (node == editorData_->GetEditorScene() || node->GetComponent<Terrain>() != NULL)
+			return;
+
+		SelectionDebugItem item;
+		item.subtree_ = false;
+
+		// Deep subtrees are drawn as a single box around their drawables
+		if (depth > DEBUG_DETAIL_DEPTH)
 		{
-			for (unsigned int j = 0; j < node->GetNumComponents(); ++j)
-				node->GetComponents()[j]->DrawDebugGeometry(debug, false);
+			PODVector<Drawable*> drawables;
+			node->GetComponents<Drawable>(drawables, true);
+			for (unsigned int i = 0; i < drawables.Size(); ++i)
+				item.box_.Merge(drawables[i]->GetWorldBoundingBox());
+			if (item.box_.Defined())
+			{
+				item.subtree_ = true;
+				selectionDebugItems.Push(item);
+			}
+			return;
+		}
 
-			// To avoid cluttering the view, do not draw the node axes for child nodes
-			for (unsigned int k = 0; k < node->GetNumChildren(); ++k)
-				DrawNodeDebug(node->GetChildren()[k], debug, false);
+		for (unsigned int j = 0; j < node->GetNumComponents(); ++j)
+		{
+			Component* component = node->GetComponents()[j];
+			Drawable* drawable = dynamic_cast<Drawable*>(component);
+			item.component_ = component;
+			item.box_ = drawable ? drawable->GetWorldBoundingBox() : BoundingBox();
+			selectionDebugItems.Push(item);
 		}
+
+		for (unsigned int k = 0; k < node->GetNumChildren(); ++k)
+			CollectNodeDebug(node->GetChildren()[k], depth + 1);
 	}
 
 	bool EPScene3D::MoveNodes(Vector3 adjust)
 	{
-		bool moved = false;
+		if (adjust.Length() <= M_EPSILON)
+			return false;
 
-		if (adjust.Length() > M_EPSILON)
+		if (moveSnap)
 		{
-			for (unsigned int i = 0; i < editorSelection_->GetNumEditNodes(); ++i)
-			{
-				if (moveSnap)
-				{
-					float moveStepScaled = moveStep * snapScale;
-					adjust.x_ = floor(adjust.x_ / moveStepScaled + 0.5f) * moveStepScaled;
-					adjust.y_ = floor(adjust.y_ / moveStepScaled + 0.5f) * moveStepScaled;
-					adjust.z_ = floor(adjust.z_ / moveStepScaled + 0.5f) * moveStepScaled;
-				}
-
-				Node* node = editorSelection_->GetEditNodes()[i];
-				Vector3 nodeAdjust = adjust;
-				if (axisMode == AXIS_LOCAL && editorSelection_->GetNumEditNodes() == 1)
-					nodeAdjust = node->GetWorldRotation() * nodeAdjust;
-
-				Vector3 worldPos = node->GetWorldPosition();
-				Vector3 oldPos = node->GetPosition();
+			float moveStepScaled = moveStep * snapScale;
+			adjust.x_ = floor(adjust.x_ / moveStepScaled + 0.5f) * moveStepScaled;
+			adjust.y_ = floor(adjust.y_ / moveStepScaled + 0.5f) * moveStepScaled;
+			adjust.z_ = floor(adjust.z_ / moveStepScaled + 0.5f) * moveStepScaled;
+		}
 
-				worldPos += nodeAdjust;
+		bool localAxis = axisMode == AXIS_LOCAL && editorSelection_->GetNumEditNodes() == 1;
 
-				if (node->GetParent() == NULL)
-					node->SetPosition(worldPos);
-				else
-					node->SetPosition(node->GetParent()->WorldToLocal(worldPos));
+		CollectTransformRoots();
+		pendingTransforms.Resize(transformRoots.Size());
+		for (unsigned int i = 0; i < transformRoots.Size(); ++i)
+		{
+			Node* node = transformRoots[i];
+			Node* parent = node->GetParent();
+			Vector3 worldPos = node->GetWorldPosition() + (localAxis ? node->GetWorldRotation() * adjust : adjust);
 
-				if (node->GetPosition() != oldPos)
-					moved = true;
-			}
+			NodeTransform& transform = pendingTransforms[i];
+			transform.node_ = node;
+			transform.position_ = parent ? parent->WorldToLocal(worldPos) : worldPos;
+			transform.rotation_ = node->GetRotation();
+			transform.scale_ = node->GetScale();
 		}
 
-		return moved;
+		return CommitTransforms();
 	}
 
 	bool EPScene3D::RotateNodes(Vector3 adjust)
 	{
-		bool moved = false;
-
 		if (rotateSnap)
 		{
 			float rotateStepScaled = rotateStep * snapScale;
@@ -866,78 +1070,144 @@ namespace Urho3D
 			adjust.z_ = floor(adjust.z_ / rotateStepScaled + 0.5f) * rotateStepScaled;
 		}
 
-		if (adjust.Length() > M_EPSILON)
+		if (adjust.Length() <= M_EPSILON)
+			return false;
+
+		bool localAxis = axisMode == AXIS_LOCAL && editorSelection_->GetNumEditNodes() == 1;
+
+		CollectTransformRoots();
+		pendingTransforms.Resize(transformRoots.Size());
+		for (unsigned int i = 0; i < transformRoots.Size(); ++i)
 		{
-			moved = true;
+			Node* node = transformRoots[i];
+			Node* parent = node->GetParent();
+			Quaternion rotQuat(adjust.x_, adjust.y_, adjust.z_);
 
-			for (unsigned int i = 0; i < editorSelection_->GetNumEditNodes(); ++i)
+			NodeTransform& transform = pendingTransforms[i];
+			transform.node_ = node;
+			transform.scale_ = node->GetScale();
+			if (localAxis)
 			{
-				Node* node = editorSelection_->GetEditNodes()[i];
-				Quaternion rotQuat(adjust.x_, adjust.y_, adjust.z_);
-				if (axisMode == AXIS_LOCAL && editorSelection_->GetNumEditNodes() == 1)
-					node->SetRotation(node->GetRotation() * rotQuat);
-				else
-				{
-					Vector3 offset = node->GetWorldPosition();/// \todo -gizmoAxisX.axisRay.origin;
-
-					if (node->GetParent() != NULL && node->GetParent()->GetWorldRotation() != Quaternion(1, 0, 0, 0))
-						rotQuat = node->GetParent()->GetWorldRotation().Inverse() * rotQuat * node->GetParent()->GetWorldRotation();
+				transform.position_ = node->GetPosition();
+				transform.rotation_ = node->GetRotation() * rotQuat;
+			}
+			else
+			{
+				Vector3 offset = node->GetWorldPosition();/// \todo -gizmoAxisX.axisRay.origin;
 
-					node->SetRotation(rotQuat * node->GetRotation());
-					Vector3 newPosition = rotQuat * offset; /// \todo gizmoAxisX.axisRay.origin +
+				if (parent != NULL && parent->GetWorldRotation() != Quaternion(1, 0, 0, 0))
+					rotQuat = parent->GetWorldRotation().Inverse() * rotQuat * parent->GetWorldRotation();
 
-					if (node->GetParent() != NULL)
-						newPosition = node->GetParent()->WorldToLocal(newPosition);
+				transform.rotation_ = rotQuat * node->GetRotation();
+				Vector3 newPosition = rotQuat * offset; /// \todo gizmoAxisX.axisRay.origin +
 
-					node->SetPosition(newPosition);
-				}
+				transform.position_ = parent != NULL ? parent->WorldToLocal(newPosition) : newPosition;
 			}
 		}
 
-		return moved;
+		CommitTransforms();
+		return true;
 	}
 
 	bool EPScene3D::ScaleNodes(Vector3 adjust)
 	{
-		bool moved = false;
+		if (adjust.Length() <= M_EPSILON)
+			return false;
 
-		if (adjust.Length() > M_EPSILON)
-		{
-			for (unsigned int i = 0; i < editorSelection_->GetNumEditNodes(); ++i)
-			{
-				Node* node = editorSelection_->GetEditNodes()[i];
+		float scaleStepScaled = scaleStep * snapScale;
 
-				Vector3 scale = node->GetScale();
-				Vector3 oldScale = scale;
+		CollectTransformRoots();
+		pendingTransforms.Resize(transformRoots.Size());
+		for (unsigned int i = 0; i < transformRoots.Size(); ++i)
+		{
+			Node* node = transformRoots[i];
+			Vector3 scale = node->GetScale();
 
-				if (!scaleSnap)
-					scale += adjust;
-				else
+			if (!scaleSnap)
+				scale += adjust;
+			else
+			{
+				if (adjust.x_ != 0)
 				{
-					float scaleStepScaled = scaleStep * snapScale;
-					if (adjust.x_ != 0)
-					{
-						scale.x_ += adjust.x_ * scaleStepScaled;
-						scale.x_ = floor(scale.x_ / scaleStepScaled + 0.5f) * scaleStepScaled;
-					}
-					if (adjust.y_ != 0)
-					{
-						scale.y_ += adjust.y_ * scaleStepScaled;
-						scale.y_ = floor(scale.y_ / scaleStepScaled + 0.5f) * scaleStepScaled;
-					}
-					if (adjust.z_ != 0)
-					{
-						scale.z_ += adjust.z_ * scaleStepScaled;
-						scale.z_ = floor(scale.z_ / scaleStepScaled + 0.5f) * scaleStepScaled;
-					}
+					scale.x_ += adjust.x_ * scaleStepScaled;
+					scale.x_ = floor(scale.x_ / scaleStepScaled + 0.5f) * scaleStepScaled;
 				}
+				if (adjust.y_ != 0)
+				{
+					scale.y_ += adjust.y_ * scaleStepScaled;
+					scale.y_ = floor(scale.y_ / scaleStepScaled + 0.5f) * scaleStepScaled;
+				}
+				if (adjust.z_ != 0)
+				{
+					scale.z_ += adjust.z_ * scaleStepScaled;
+					scale.z_ = floor(scale.z_ / scaleStepScaled + 0.5f) * scaleStepScaled;
+				}
+			}
 
-				if (scale != oldScale)
-					moved = true;
+			NodeTransform& transform = pendingTransforms[i];
+			transform.node_ = node;
+			transform.position_ = node->GetPosition();
+			transform.rotation_ = node->GetRotation();
+			transform.scale_ = scale;
+		}
+
+		return CommitTransforms();
+	}
 
-				node->SetScale(scale);
+	void EPScene3D::CollectTransformRoots()
+	{
+		Vector<Node*>& editNodes = editorSelection_->GetEditNodes();
+		transformRoots.Clear();
+		if (editNodes.Size() < 2)
+		{
+			if (!editNodes.Empty())
+				transformRoots.Push(editNodes[0]);
+			return;
+		}
+
+		// Children of edited nodes follow their parent, transforming them as well would apply the adjustment twice
+		transformEditNodes.Clear();
+		for (unsigned int i = 0; i < editNodes.Size(); ++i)
+			transformEditNodes.Insert(editNodes[i]);
+
+		for (unsigned int i = 0; i < editNodes.Size(); ++i)
+		{
+			Node* parent = editNodes[i]->GetParent();
+			while (parent != NULL && !transformEditNodes.Contains(parent))
+				parent = parent->GetParent();
+			if (parent == NULL)
+				transformRoots.Push(editNodes[i]);
+		}
+	}
+
+	bool EPScene3D::CommitTransforms()
+	{
+		// The loaded nodes are not edited before the load finishes
+		if (IsLoadingScene())
+		{
+			pendingTransforms.Clear();
+			return false;
+		}
+
+		// All transforms were computed from clean world transforms, now dirty each node once
+		bool moved = false;
+		for (unsigned int i = 0; i < pendingTransforms.Size(); ++i)
+		{
+			const NodeTransform& transform = pendingTransforms[i];
+			Node* node = transform.node_;
+			if (transform.position_ != node->GetPosition() || transform.rotation_ != node->GetRotation() || transform.scale_ != node->GetScale())
+			{
+				node->SetTransform(transform.position_, transform.rotation_, transform.scale_);
+				// Transforms send no scene event
+				if (autosaveJournal)
+					autosaveJournal->MarkDirty(node);
+				moved = true;
 			}
 		}
+		pendingTransforms.Clear();
+
+		if (moved)
+			picking_->MarkTransformsDirty();
 
 		return moved;
 	}
@@ -951,6 +1221,10 @@ namespace Urho3D
 		// Ignore if mouse is grabbed by other operation
 		if (input_->IsMouseGrabbed())
 			return;
+
+		// Nothing is selected for editing while the scene is loading
+		if (IsLoadingScene())
+			return;
 		Scene* editorScene = editorData_->GetEditorScene();
 
 		Input* input = GetSubsystem<Input>();
@@ -999,14 +1273,32 @@ namespace Urho3D
 		Ray cameraRay = camera_->GetScreenRay(posx, posy);
 
 		Component* selectedComponent = NULL;
-		if (pickMode < PICK_RIGIDBODIES)
+		Component* highlight = NULL;
+		unsigned modificationCount = picking_->GetModificationCount();
+
+		++hoverPickQueries;
+		// Reuse the last pick while the ray and the scene are unchanged
+		if (hoverCacheValid && cameraRay == hoverRay && pickMode == hoverPickMode && modificationCount == hoverModificationCount)
+		{
+			++hoverPickHits;
+			selectedComponent = hoverSelected;
+			highlight = hoverHighlight;
+		}
+		else if (pickMode < PICK_RIGIDBODIES)
 		{
 			if (editorScene->GetComponent<Octree>() == NULL)
 				return;
 
 			PODVector<RayQueryResult> result_;
-			editorScene->GetComponent<Octree>()->RaycastSingle(RayOctreeQuery(result_,cameraRay, RAY_TRIANGLE, camera_->GetFarClip(),
-				pickModeDrawableFlags[pickMode], 0x7fffffff));
+			if (usePickingBVH)
+			{
+				result_.Resize(1);
+				if (!picking_->RaycastSingle(cameraRay, camera_->GetFarClip(), pickModeDrawableFlags[pickMode], 0x7fffffff, result_[0]))
+					result_.Clear();
+			}
+			else
+				editorScene->GetComponent<Octree>()->RaycastSingle(RayOctreeQuery(result_,cameraRay, RAY_TRIANGLE, camera_->GetFarClip(),
+					pickModeDrawableFlags[pickMode], 0x7fffffff));
 
 			if (result_.Size() != 0 && result_[0].drawable_ != NULL)
 			{
@@ -1015,11 +1307,7 @@ namespace Urho3D
 				if (drawable->GetTypeName() != "TerrainPatch")
 				{
 					selectedComponent = drawable;
-					if (debug != NULL)
-					{
-						debug->AddNode(drawable->GetNode(), 1.0, false);
-						drawable->DrawDebugGeometry(debug, false);
-					}
+					highlight = drawable;
 				}
 				else if (drawable->GetNode()->GetParent() != NULL)
 					selectedComponent = drawable->GetNode()->GetParent()->GetComponent<Terrain>();
@@ -1030,27 +1318,46 @@ namespace Urho3D
 			if (editorScene->GetComponent<PhysicsWorld>() == NULL)
 				return;
 
-			// If we are not running the actual physics update, refresh collisions before raycasting
+			// If we are not running the actual physics update, refresh the bounds of moved bodies before raycasting
 			if (!runUpdate)
-				editorScene->GetComponent<PhysicsWorld>()->UpdateCollisions();
+				picking_->UpdatePhysicsBounds(editorScene->GetComponent<PhysicsWorld>());
 
 			PhysicsRaycastResult result;
 			editorScene->GetComponent<PhysicsWorld>()->RaycastSingle(result,cameraRay, camera_->GetFarClip());
 
 			if (result.body_ != NULL)
 			{
-				RigidBody* body = result.body_;
-				if (debug != NULL)
-				{
-					debug->AddNode(body->GetNode(), 1.0, false);
-					body->DrawDebugGeometry(debug, false);
-				}
-				selectedComponent = body;
+				selectedComponent = result.body_;
+				highlight = result.body_;
 			}
 		}
 
+		// The hover highlight is debug geometry, redraw when it moves to another object
+		if (highlight != hoverHighlight)
+			QueueViewUpdates();
+
+		hoverCacheValid = true;
+		hoverRay = cameraRay;
+		hoverPickMode = pickMode;
+		hoverModificationCount = modificationCount;
+		hoverSelected = selectedComponent;
+		hoverHighlight = highlight;
+
+		if (debug != NULL && highlight != NULL)
+		{
+			debug->AddNode(highlight->GetNode(), 1.0, false);
+			highlight->DrawDebugGeometry(debug, false);
+		}
+
 		if (mouseClick && input->GetMouseButtonPress(MOUSEB_LEFT))
 		{
+			// In select mode a drag from here becomes a marquee selection
+			if (editMode == EDIT_SELECT && pickMode < PICK_RIGIDBODIES)
+			{
+				marqueeActive = true;
+				marqueeStart = pos;
+			}
+
 			bool multiselect = input->GetQualifierDown(QUAL_CTRL);
 			if (selectedComponent != NULL)
 			{
@@ -1079,6 +1386,305 @@ namespace Urho3D
 
 	}
 
+	void EPScene3D::UpdateMarquee()
+	{
+		if (!marqueeActive)
+			return;
+
+		IntVector2 pos = ui_->GetCursorPosition();
+		IntVector2 min(Min(marqueeStart.x_, pos.x_), Min(marqueeStart.y_, pos.y_));
+		IntVector2 max(Max(marqueeStart.x_, pos.x_), Max(marqueeStart.y_, pos.y_));
+		bool dragged = max.x_ - min.x_ >= MARQUEE_MIN_SIZE || max.y_ - min.y_ >= MARQUEE_MIN_SIZE;
+
+		if (marqueeRect.Null())
+		{
+			marqueeRect = activeView->CreateChild<BorderImage>("MarqueeRect");
+			marqueeRect->SetColor(Color(0.4f, 0.6f, 1.0f, 0.25f));
+			marqueeRect->SetPriority(100);
+			marqueeRect->SetVisible(false);
+		}
+
+		if (input_->GetMouseButtonDown(MOUSEB_LEFT))
+		{
+			marqueeRect->SetVisible(dragged);
+			if (dragged)
+			{
+				marqueeRect->SetPosition(min - activeView->GetScreenPosition());
+				marqueeRect->SetSize(max - min);
+			}
+			return;
+		}
+
+		marqueeActive = false;
+		marqueeRect->SetVisible(false);
+		if (dragged && editMode == EDIT_SELECT && pickMode < PICK_RIGIDBODIES)
+			MarqueeSelect(min, max, input_->GetQualifierDown(QUAL_CTRL));
+	}
+
+	void EPScene3D::MarqueeSelect(const IntVector2& min, const IntVector2& max, bool multiselect)
+	{
+		if (IsLoadingScene())
+			return;
+
+		Scene* editorScene = editorData_->GetEditorScene();
+		Octree* octree = editorScene->GetComponent<Octree>();
+		if (octree == NULL)
+			return;
+
+		const IntVector2& screenpos = activeView->GetScreenPosition();
+		float left = float(min.x_ - screenpos.x_) / float(activeView->GetWidth());
+		float right = float(max.x_ - screenpos.x_) / float(activeView->GetWidth());
+		float top = float(min.y_ - screenpos.y_) / float(activeView->GetHeight());
+		float bottom = float(max.y_ - screenpos.y_) / float(activeView->GetHeight());
+		float nearClip = camera_->GetNearClip();
+		float farClip = camera_->GetFarClip();
+
+		// Sub-frustum through the marquee corners, in the vertex order of Frustum::Define()
+		Frustum frustum;
+		frustum.vertices_[0] = camera_->ScreenToWorldPoint(Vector3(right, top, nearClip));
+		frustum.vertices_[1] = camera_->ScreenToWorldPoint(Vector3(right, bottom, nearClip));
+		frustum.vertices_[2] = camera_->ScreenToWorldPoint(Vector3(left, bottom, nearClip));
+		frustum.vertices_[3] = camera_->ScreenToWorldPoint(Vector3(left, top, nearClip));
+		frustum.vertices_[4] = camera_->ScreenToWorldPoint(Vector3(right, top, farClip));
+		frustum.vertices_[5] = camera_->ScreenToWorldPoint(Vector3(right, bottom, farClip));
+		frustum.vertices_[6] = camera_->ScreenToWorldPoint(Vector3(left, bottom, farClip));
+		frustum.vertices_[7] = camera_->ScreenToWorldPoint(Vector3(left, top, farClip));
+		frustum.UpdatePlanes();
+
+		PODVector<Drawable*> drawables;
+		FrustumOctreeQuery query(drawables, frustum, pickModeDrawableFlags[pickMode], 0x7fffffff);
+		octree->GetDrawables(query);
+
+		PODVector<Node*> nodes;
+		HashSet<Node*> added;
+		for (unsigned int i = 0; i < drawables.Size(); ++i)
+		{
+			Node* node = drawables[i]->GetNode();
+			// If selecting a terrain patch, select the parent terrain instead
+			if (drawables[i]->GetTypeName() == "TerrainPatch")
+				node = node->GetParent();
+			if (node != NULL && node != editorScene && !added.Contains(node))
+			{
+				added.Insert(node);
+				nodes.Push(node);
+			}
+		}
+
+		SelectNodes(nodes, multiselect);
+	}
+
+	void EPScene3D::SelectNodes(const PODVector<Node*>& nodes, bool multiselect)
+	{
+		HierarchyWindow* hierarchyWindow = editor_->GetHierarchyWindow();
+		HierarchyList* hierarchyList = hierarchyWindow->GetHierarchyList();
+
+		// Reveal nodes below items not yet expanded first, all together since populating moves the items after them
+		PODVector<Serializable*> unlisted;
+		for (unsigned int i = 0; i < nodes.Size(); ++i)
+		{
+			if (hierarchyWindow->GetListIndex(nodes[i]) == NO_ITEM)
+				unlisted.Push(nodes[i]);
+		}
+		if (!unlisted.Empty())
+			hierarchyWindow->RevealItems(unlisted);
+
+		PODVector<unsigned> indices;
+		HashSet<unsigned> selected;
+		if (multiselect)
+		{
+			const PODVector<unsigned>& selections = hierarchyList->GetSelections();
+			for (unsigned int i = 0; i < selections.Size(); ++i)
+			{
+				selected.Insert(selections[i]);
+				indices.Push(selections[i]);
+			}
+		}
+
+		// Rows come from the hierarchy window's index, so this is linear in the selection rather than the list
+		for (unsigned int i = 0; i < nodes.Size(); ++i)
+		{
+			unsigned int index = hierarchyWindow->GetListIndex(nodes[i]);
+			if (index != NO_ITEM && !selected.Contains(index))
+			{
+				selected.Insert(index);
+				indices.Push(index);
+			}
+		}
+
+		// This causes a single selection changed event, in response we set the node/component selections, and refresh editors
+		if (indices.Empty())
+		{
+			if (!multiselect)
+				hierarchyList->ClearSelection();
+		}
+		else
+			hierarchyList->SetSelections(indices);
+	}
+
+	void EPScene3D::SetRenderOnDemand(bool enable)
+	{
+		renderOnDemand = enable;
+		UpdateViewModes();
+		activeView->ResetFrameCounters();
+		QueueViewUpdates();
+	}
+
+	void EPScene3D::SetInactiveViewUpdateInterval(float interval)
+	{
+		inactiveViewUpdateInterval = Max(interval, 0.0f);
+		UpdateViewModes();
+		QueueViewUpdates();
+	}
+
+	void EPScene3D::HandleViewChanged(StringHash eventType, VariantMap& eventData)
+	{
+		selectionDebugDirty = true;
+		QueueViewUpdates();
+	}
+
+	EPScene3DView* EPScene3D::CreateView()
+	{
+		EPScene3DView* view = window_->CreateChild<EPScene3DView>("Scene3DView");
+		view->SetDefaultStyle(editorData_->GetDefaultStyle());
+		view->SetView(editorData_->GetEditorScene());
+		view->CreateViewportContextUI(editorData_->GetDefaultStyle(), editorData_->GetIconStyle());
+		view->camera_->SetNearClip(viewNearClip);
+		view->camera_->SetFarClip(viewFarClip);
+		view->camera_->SetFov(viewFov);
+		view->camera_->SetFillMode(fillMode);
+		view->SetTargetFrameTime(targetFrameTime);
+		view->SetDynamicResolution(dynamicResolution);
+		views_.Push(SharedPtr<EPScene3DView>(view));
+		return view;
+	}
+
+	void EPScene3D::ResetViewCamera(unsigned index)
+	{
+		if (index >= views_.Size())
+			return;
+
+		EPScene3DView* view = views_[index];
+		view->ResetCamera();
+		if (index == 0)
+		{
+			view->SetOrthographic(false);
+			return;
+		}
+
+		// Additional panes look along the world axes: top, front, side
+		const Vector3& direction = viewPaneDirections[(index - 1) % 3];
+		view->cameraNode_->SetPosition(-direction * ORTHO_VIEW_DISTANCE);
+		view->cameraNode_->SetRotation(Quaternion(Vector3(0.0f, 0.0f, 1.0f), direction));
+		view->ReacquireCameraYawPitch();
+		view->camera_->SetOrthoSize(ORTHO_VIEW_SIZE);
+		view->SetOrthographic(true);
+	}
+
+	void EPScene3D::SetViewportLayout(ViewportLayout layout)
+	{
+		unsigned int numViews = layout == VIEWPORT_QUAD ? 4 : (layout == VIEWPORT_SPLIT ? 2 : 1);
+
+		while (views_.Size() > numViews)
+		{
+			if (views_.Back() == activeView)
+				SetActiveView(views_[0]);
+			views_.Back()->Remove();
+			views_.Pop();
+		}
+		while (views_.Size() < numViews)
+		{
+			CreateView();
+			ResetViewCamera(views_.Size() - 1);
+		}
+
+		viewportLayout = layout;
+		LayoutViews();
+		UpdateViewModes();
+		QueueViewUpdates();
+	}
+
+	void EPScene3D::LayoutViews()
+	{
+		IntVector2 size = window_->GetSize();
+		int halfWidth = size.x_ / 2;
+		int halfHeight = size.y_ / 2;
+
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+		{
+			IntRect rect(0, 0, size.x_, size.y_);
+			if (viewportLayout == VIEWPORT_SPLIT)
+				rect = i == 0 ? IntRect(0, 0, halfWidth, size.y_) : IntRect(halfWidth + VIEW_PANE_SPACING, 0, size.x_, size.y_);
+			else if (viewportLayout == VIEWPORT_QUAD)
+			{
+				rect.left_ = (i & 1) ? halfWidth + VIEW_PANE_SPACING : 0;
+				rect.right_ = (i & 1) ? size.x_ : halfWidth;
+				rect.top_ = (i & 2) ? halfHeight + VIEW_PANE_SPACING : 0;
+				rect.bottom_ = (i & 2) ? size.y_ : halfHeight;
+			}
+
+			views_[i]->SetPosition(rect.left_, rect.top_);
+			views_[i]->SetSize(rect.right_ - rect.left_, rect.bottom_ - rect.top_);
+		}
+	}
+
+	void EPScene3D::SetActiveView(EPScene3DView* view)
+	{
+		if (view == NULL)
+			return;
+
+		activeView = view;
+		cameraNode_ = view->GetCameraNode();
+		camera_ = view->GetCamera();
+
+		// The stats bar and marquee belong to the view receiving input
+		if (editorModeText)
+			view->AddChild(editorModeText);
+		if (renderStatsText)
+			view->AddChild(renderStatsText);
+		if (marqueeRect)
+			view->AddChild(marqueeRect);
+		if (loadProgress)
+			view->AddChild(loadProgress);
+		marqueeActive = false;
+		hoverCacheValid = false;
+
+		UpdateViewModes();
+		QueueViewUpdates();
+	}
+
+	void EPScene3D::UpdateViewModes()
+	{
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+		{
+			EPScene3DView* view = views_[i];
+			if (view == activeView)
+			{
+				view->SetAutoUpdate(!renderOnDemand);
+				view->SetUpdateInterval(0.0f);
+			}
+			else
+			{
+				view->SetAutoUpdate(false);
+				view->SetUpdateInterval(inactiveViewUpdateInterval);
+			}
+		}
+	}
+
+	void EPScene3D::QueueViewUpdates()
+	{
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+			views_[i]->QueueUpdate();
+	}
+
+	void EPScene3D::BenchmarkPicking()
+	{
+		if (pickMode >= PICK_RIGIDBODIES)
+			return;
+
+		Ray cameraRay = camera_->GetScreenRay(0.5f, 0.5f);
+		picking_->Benchmark(cameraRay, camera_->GetFarClip(), pickModeDrawableFlags[pickMode], 0x7fffffff);
+	}
+
 	void EPScene3D::SelectComponent(Component* component, bool multiselect)
 	{
 		if (component == NULL && !multiselect)
@@ -1093,26 +1699,16 @@ namespace Urho3D
 			editor_->GetHierarchyWindow()->GetHierarchyList()->ClearSelection();
 			return;
 		}
-		ListView* hierarchyList = editor_->GetHierarchyWindow()->GetHierarchyList();
+		HierarchyWindow* hierarchyWindow = editor_->GetHierarchyWindow();
+		HierarchyList* hierarchyList = hierarchyWindow->GetHierarchyList();
 
-		unsigned int nodeIndex = editor_->GetHierarchyWindow()->GetListIndex(node);
-		unsigned int componentIndex = editor_->GetHierarchyWindow()->GetComponentListIndex(component);
-		unsigned int numItems = hierarchyList->GetNumItems();
+		unsigned int componentIndex = hierarchyWindow->GetComponentListIndex(component);
+		// Populate and expand only the node chain, the component may not have an item yet
+		if (componentIndex == NO_ITEM || !multiselect || !hierarchyList->IsSelected(componentIndex))
+			componentIndex = hierarchyWindow->RevealItem(component);
 
-		if (nodeIndex < numItems && componentIndex < numItems)
+		if (componentIndex != NO_ITEM)
 		{
-			// Expand the node chain now
-			if (!multiselect || !hierarchyList->IsSelected(componentIndex))
-			{
-				// Go in the parent chain up to make sure the chain is expanded
-				Node* current = node;
-				do
-				{
-					hierarchyList->Expand(editor_->GetHierarchyWindow()->GetListIndex(current), true);
-					current = current->GetParent();
-				} while (current != NULL);
-			}
-
 			// This causes an event to be sent, in response we set the node/component selections, and refresh editors
 			if (!multiselect)
 				hierarchyList->SetSelection( componentIndex);
@@ -1130,24 +1726,16 @@ namespace Urho3D
 			editor_->GetHierarchyWindow()->GetHierarchyList()->ClearSelection();
 			return;
 		}
-		ListView* hierarchyList = editor_->GetHierarchyWindow()->GetHierarchyList();
-		unsigned int index = editor_->GetHierarchyWindow()->GetListIndex(node);
-		unsigned int numItems = hierarchyList->GetNumItems();
+		HierarchyWindow* hierarchyWindow = editor_->GetHierarchyWindow();
+		HierarchyList* hierarchyList = hierarchyWindow->GetHierarchyList();
 
-		if (index < numItems)
-		{
-			// Expand the node chain now
-			if (!multiselect || !hierarchyList->IsSelected(index))
-			{
-				// Go in the parent chain up to make sure the chain is expanded
-				Node* current = node;
-				do
-				{
-					hierarchyList->Expand(editor_->GetHierarchyWindow()->GetListIndex(current), true);
-					current = current->GetParent();
-				} while (current != NULL);
-			}
+		unsigned int index = hierarchyWindow->GetListIndex(node);
+		// Populate and expand only the parent chain, the node may not have an item yet
+		if (index == NO_ITEM || !multiselect || !hierarchyList->IsSelected(index))
+			index = hierarchyWindow->RevealItem(node);
 
+		if (index != NO_ITEM)
+		{
 			// This causes an event to be sent, in response we set the node/component selections, and refresh editors
 			if (!multiselect)
 				hierarchyList->SetSelection( index);
@@ -1192,6 +1780,12 @@ namespace Urho3D
 		}
 	}
 
+	void EPScene3D::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+	{
+		// The camera has moved for this frame, the octree has not been updated yet
+		UpdateGridPlacement();
+	}
+
 	void EPScene3D::HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace PostRenderUpdate;
@@ -1202,29 +1796,34 @@ namespace Urho3D
 		if (debug == NULL)
 			return;
 
-		// Visualize the currently selected nodes
-		for (unsigned int i = 0; i < editorSelection_->GetNumSelectedNodes(); ++i)
-			DrawNodeDebug(editorSelection_->GetSelectedNodes()[i], debug);
+		{
+			ScopedStageTimer timer(this, STAGE_DEBUGDRAW);
 
-		// Visualize the currently selected components
-		for (unsigned int i = 0; i < editorSelection_->GetNumSelectedComponents(); ++i)
-			editorSelection_->GetSelectedComponents()[i]->DrawDebugGeometry(debug, false);
+			// Visualize the currently selected nodes
+			DrawSelectionDebug(debug);
+			gizmo_->DrawPreview(debug);
 
-		// Visualize the currently selected UI-elements
-		for (unsigned int i = 0; i < editorSelection_->GetNumSelectedUIElements(); ++i)
-			ui_->DebugDraw(editorSelection_->GetSelectedUIElements()[i]);
+			// Visualize the currently selected components
+			for (unsigned int i = 0; i < editorSelection_->GetNumSelectedComponents(); ++i)
+				editorSelection_->GetSelectedComponents()[i]->DrawDebugGeometry(debug, false);
 
-		if (renderingDebug)
-			renderer->DrawDebugGeometry(false);
+			// Visualize the currently selected UI-elements
+			for (unsigned int i = 0; i < editorSelection_->GetNumSelectedUIElements(); ++i)
+				ui_->DebugDraw(editorSelection_->GetSelectedUIElements()[i]);
 
-		PhysicsWorld* physics = scene->GetComponent<PhysicsWorld>();
-		if (physicsDebug && physics != NULL)
-			physics->DrawDebugGeometry(true);
+			if (renderingDebug)
+				renderer->DrawDebugGeometry(false);
 
-		Octree* octree = scene->GetComponent<Octree>();
-		if (octreeDebug && octree != NULL)
-			octree->DrawDebugGeometry(true);
+			PhysicsWorld* physics = scene->GetComponent<PhysicsWorld>();
+			if (physicsDebug && physics != NULL)
+				physics->DrawDebugGeometry(true);
+
+			Octree* octree = scene->GetComponent<Octree>();
+			if (octreeDebug && octree != NULL)
+				octree->DrawDebugGeometry(true);
+		}
 
+		ScopedStageTimer timer(this, STAGE_HOVERRAYCAST);
 		ViewRaycast(false);
 	}
 
@@ -1232,6 +1831,17 @@ namespace Urho3D
 	{
 		using namespace UIMouseClick;
 
+		// Clicking into another pane makes it the active one
+		UIElement* element = static_cast<UIElement*>(eventData[P_ELEMENT].GetPtr());
+		for (unsigned int i = 0; i < views_.Size(); ++i)
+		{
+			if (views_[i] == element && element != activeView)
+			{
+				SetActiveView(views_[i]);
+				break;
+			}
+		}
+
 		ViewRaycast(true);
 	}
 
@@ -1267,8 +1877,7 @@ namespace Urho3D
 
 	void EPScene3D::HandleResizeView(StringHash eventType, VariantMap& eventData)
 	{
-		if (activeView)
-			activeView->SetSize(window_->GetSize());
+		LayoutViews();
 	}
 
 	void EPScene3D::HandleMenuBarAction(StringHash eventType, VariantMap& eventData)
@@ -1285,6 +1894,10 @@ namespace Urho3D
 			editor_->CreateFileSelector("Open scene", "Open", "Cancel", editorData_->uiScenePath, editorData_->uiSceneFilters, editorData_->uiSceneFilter);
 			SubscribeToEvent(editor_->GetUIFileSelector(), E_FILESELECTED, HANDLER(EPScene3D, HandleOpenSceneFile));
 		}
+		else if ((action == A_SAVESCENE_VAR || action == A_SAVESCENEAS_VAR) && IsLoadingScene())
+		{
+			MessageBox(context_, "The scene is still loading.\nSave it once loading has finished.");
+		}
 		else if (action == A_SAVESCENE_VAR || action == A_SAVESCENEAS_VAR)
 		{
 			editor_->CreateFileSelector("Save scene as", "Save", "Cancel", editorData_->uiScenePath, editorData_->uiSceneFilters, editorData_->uiSceneFilter);
@@ -1312,6 +1925,53 @@ namespace Urho3D
 				SubscribeToEvent(editor_->GetUIFileSelector(), E_FILESELECTED, HANDLER(EPScene3D, HandleSaveNodeFile));
 			}
 		}
+		else if (action == A_BENCHMARKPICKING_VAR)
+		{
+			BenchmarkPicking();
+		}
+		else if (action == A_BENCHMARKHIERARCHY_VAR)
+		{
+			editor_->GetHierarchyWindow()->Benchmark();
+		}
+		else if (action == A_EXPORTFRAMETIMES_VAR)
+		{
+			if (GetSubsystem<EditorProfiler>())
+				GetSubsystem<EditorProfiler>()->ExportCSV(fileSystem_->GetProgramDir() + "EditorFrameTimes.csv");
+		}
+		else if (action == A_RENDERONDEMAND_VAR)
+		{
+			SetRenderOnDemand(!renderOnDemand);
+		}
+		else if (action == A_DYNAMICRESOLUTION_VAR)
+		{
+			dynamicResolution = !dynamicResolution;
+			for (unsigned int i = 0; i < views_.Size(); ++i)
+				views_[i]->SetDynamicResolution(dynamicResolution);
+		}
+		else if (action == A_GIZMOPREVIEW_VAR)
+		{
+			gizmoPreview = !gizmoPreview;
+		}
+		else if (action == A_VIEWLAYOUTSINGLE_VAR)
+		{
+			SetViewportLayout(VIEWPORT_SINGLE);
+		}
+		else if (action == A_VIEWLAYOUTSPLIT_VAR)
+		{
+			SetViewportLayout(VIEWPORT_SPLIT);
+		}
+		else if (action == A_VIEWLAYOUTQUAD_VAR)
+		{
+			SetViewportLayout(VIEWPORT_QUAD);
+		}
+		else if (action == A_INACTIVEVIEWRATE_VAR)
+		{
+			// Step to the next longer interval, wrapping around to redrawing on every change
+			unsigned next = 0;
+			while (next < NUM_INACTIVE_VIEW_UPDATE_INTERVALS && INACTIVE_VIEW_UPDATE_INTERVALS[next] <= inactiveViewUpdateInterval)
+				++next;
+			SetInactiveViewUpdateInterval(INACTIVE_VIEW_UPDATE_INTERVALS[next < NUM_INACTIVE_VIEW_UPDATE_INTERVALS ? next : 0]);
+		}
 		else if (action == A_CREATEREPNODE_VAR)
 		{
 			CreateNode(REPLICATED);
@@ -1330,6 +1990,8 @@ namespace Urho3D
 			String uiname = eventData[P_UINAME].GetString();
 			CreateBuiltinObject(uiname);
 		}
+
+		QueueViewUpdates();
 	}
 
 	void EPScene3D::HandleMessageAcknowledgement(StringHash eventType, VariantMap& eventData)
@@ -1343,6 +2005,31 @@ namespace Urho3D
 		}
 	}
 
+	void EPScene3D::HandleAutosaveRecovery(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace MessageACK;
+
+		Scene* scene = editorData_->GetEditorScene();
+		if (eventData[P_OK].GetBool())
+		{
+			HierarchyWindow* hierarchyWindow = editor_->GetHierarchyWindow();
+			hierarchyWindow->SetSuppressSceneChanges(true);
+			// The recovered changes are not saved yet
+			sceneModified = autosaveJournal->Recover(scene);
+			scene->SetUpdateEnabled(false);
+			hierarchyWindow->UpdateHierarchyItem(scene, true);
+			hierarchyWindow->SetSuppressSceneChanges(false);
+
+			ResetCamera();
+			CreateGrid();
+			SetActiveView(views_[0]);
+		}
+
+		// Start over from the current scene either way
+		autosaveJournal->Release();
+		autosaveJournal->Track(scene);
+	}
+
 	bool EPScene3D::ResetScene()
 	{
 		ui_->GetCursor()->SetShape(CS_BUSY);
@@ -1365,6 +2052,8 @@ namespace Urho3D
 		// Clear stored script attributes
 		//scriptAttributes.Clear();
 
+		CancelLoadScene();
+
 		Editor* editor = editorData_->GetEditor();
 		editor->GetHierarchyWindow()->SetSuppressSceneChanges(true);
 
@@ -1377,7 +2066,8 @@ namespace Urho3D
 		//cache.ReleaseAllResources(false);
 
 		sceneModified = false;
-		revertData = NULL;
+		if (revertSnapshot)
+			revertSnapshot->Clear();
 		StopSceneUpdate();
 
 		//		UpdateWindowTitle();
@@ -1390,7 +2080,10 @@ namespace Urho3D
 		ResetCamera();
 		//	CreateGizmo();
 		CreateGrid();
-		//	SetActiveViewport(viewports[0]);
+		SetActiveView(views_[0]);
+
+		if (autosaveJournal)
+			autosaveJournal->Track(editorData_->GetEditorScene());
 
 		return true;
 	}
@@ -1424,8 +2117,6 @@ namespace Urho3D
 		if (fileName.Empty())
 			return false;
 
-		ui_->GetCursor()->SetShape(CS_BUSY);
-
 		// Always load the scene from the filesystem, not from resource paths
 		if (!fileSystem_->FileExists(fileName))
 		{
@@ -1435,8 +2126,9 @@ namespace Urho3D
 			return false;
 		}
 
-		File file(context_);
-		if (!file.Open(fileName, FILE_READ))
+		// The scene keeps the file open until the asynchronous load finishes
+		SharedPtr<File> file(new File(context_));
+		if (!file->Open(fileName, FILE_READ))
 		{
 			LOGERRORF("Could not open file %s", fileName.CString());
 
@@ -1452,38 +2144,56 @@ namespace Urho3D
 		// 	if (!rememberResourcePath || !sceneResourcePath.StartsWith(newScenePath, false))
 		// 		SetResourcePath(newScenePath);
 
+		Scene* scene = editorData_->GetEditorScene();
+		CancelLoadScene();
+		// Nothing to recover while the scene is replaced, the journal restarts when loading finishes
+		if (autosaveJournal)
+			autosaveJournal->Release();
 		editor_->GetHierarchyWindow()->SetSuppressSceneChanges(true);
 		sceneModified = false;
-		revertData = NULL;
+		if (revertSnapshot)
+			revertSnapshot->Clear();
 		StopSceneUpdate();
 
+		editorSelection_->ClearSelection();
+		editor_->GetAttributeWindow()->GetEditNodes() = editorSelection_->GetEditNodes();
+		editor_->GetAttributeWindow()->GetEditComponents() = editorSelection_->GetEditComponents();
+		editor_->GetAttributeWindow()->GetEditUIElements() = editorSelection_->GetEditUIElements();
+		editor_->GetAttributeWindow()->Update();
+
+		// Clear first, the old scene's resources stay cached for the new one within their type budgets
+		scene->Clear();
+		GetSubsystem<ResourceRetention>()->BeginSceneSwitch();
+
+		// Resources are preloaded on the background loading thread, then the root level nodes are loaded a few per frame
+		loadTimer.Reset();
 		String extension = GetExtension(fileName);
-		bool loaded;
+		bool loading;
 		if (extension != ".xml")
-			loaded = editorData_->GetEditorScene()->Load(file);
+			loading = scene->LoadAsync(file, LOAD_SCENE_AND_RESOURCES);
 		else
-			loaded = editorData_->GetEditorScene()->LoadXML(file);
-
-		// Release resources which are not used by the new scene
-		/// \todo this creates an bug in the attribute inspector because the loaded xml files are released
-		cache_->ReleaseAllResources(false);
-
-		// Always pause the scene, and do updates manually
-		editorData_->GetEditorScene()->SetUpdateEnabled(false);
+			loading = scene->LoadAsyncXML(file, LOAD_SCENE_AND_RESOURCES);
 
 		// 	UpdateWindowTitle();
 		// 	DisableInspectorLock();
-		editor_->GetHierarchyWindow()->UpdateHierarchyItem(editorData_->GetEditorScene(), true);
+		// The scene and its own components are loaded at this point, the child nodes follow as loading progresses
+		editor_->GetHierarchyWindow()->UpdateHierarchyItem(scene, true);
+		loadedHierarchyNodes = 0;
 		// 	ClearEditActions();
-		//
 
-		editor_->GetHierarchyWindow()->SetSuppressSceneChanges(false);
-		/// \todo
-		editorSelection_->ClearSelection();
-		editor_->GetAttributeWindow()->GetEditNodes() = editorSelection_->GetEditNodes();
-		editor_->GetAttributeWindow()->GetEditComponents() = editorSelection_->GetEditComponents();
-		editor_->GetAttributeWindow()->GetEditUIElements() = editorSelection_->GetEditUIElements();
-		editor_->GetAttributeWindow()->Update();
+		if (!loading)
+		{
+			LOGERRORF("Could not load scene %s", fileName.CString());
+
+			MessageBox(context_, "Could not load scene.\n" + fileName);
+			FinishLoadScene();
+			return false;
+		}
+
+		loadingFileName = fileName;
+		SubscribeToEvent(scene, E_ASYNCLOADPROGRESS, HANDLER(EPScene3D, HandleAsyncLoadProgress));
+		SubscribeToEvent(scene, E_ASYNCLOADFINISHED, HANDLER(EPScene3D, HandleAsyncLoadFinished));
+		ShowLoadProgress(0.0f, 0, 0);
 		//
 		// 	// global variable to mostly bypass adding mru upon importing tempscene
 		// 	if (!skipMruScene)
@@ -1491,15 +2201,141 @@ namespace Urho3D
 		//
 		// 	skipMruScene = false;
 		//
+		return true;
+	}
+
+	void EPScene3D::FinishLoadScene()
+	{
+		Scene* scene = editorData_->GetEditorScene();
+		UnsubscribeFromEvent(scene, E_ASYNCLOADPROGRESS);
+		UnsubscribeFromEvent(scene, E_ASYNCLOADFINISHED);
+		if (loadProgress)
+			loadProgress->SetVisible(false);
+
+		AddLoadedHierarchyNodes();
+
+		// Resources the new scene does not use stay cached within their type budget for the next switch
+		GetSubsystem<ResourceRetention>()->EndSceneSwitch();
+
+		// Always pause the scene, and do updates manually
+		scene->SetUpdateEnabled(false);
+
+		editor_->GetHierarchyWindow()->SetSuppressSceneChanges(false);
+
 		ResetCamera();
 		// 	CreateGizmo();
 		CreateGrid();
-		// 	SetActiveViewport(viewports[0]);
+		SetActiveView(views_[0]);
+
+		if (autosaveJournal)
+			autosaveJournal->Track(scene);
 		//
 		// 	// Store all ScriptInstance and LuaScriptInstance attributes
 		// 	UpdateScriptInstances();
+	}
+
+	void EPScene3D::CancelLoadScene()
+	{
+		Scene* scene = editorData_->GetEditorScene();
+		if (!scene->IsAsyncLoading())
+			return;
+
+		scene->StopAsyncLoading();
+		UnsubscribeFromEvent(scene, E_ASYNCLOADPROGRESS);
+		UnsubscribeFromEvent(scene, E_ASYNCLOADFINISHED);
+		if (loadProgress)
+			loadProgress->SetVisible(false);
+
+		LOGINFOF("Cancelled loading scene %s after %.1f s", loadingFileName.CString(), (float)loadTimer.GetUSec(false) / 1000000.0f);
+	}
+
+	bool EPScene3D::IsLoadingScene() const
+	{
+		return editorData_->GetEditorScene()->IsAsyncLoading();
+	}
+
+	void EPScene3D::AddLoadedHierarchyNodes()
+	{
+		// Root level nodes are loaded whole, so every node added since the last call is complete
+		Scene* scene = editorData_->GetEditorScene();
+		HierarchyWindow* hierarchyWindow = editor_->GetHierarchyWindow();
+		const Vector<SharedPtr<Node> >& children = scene->GetChildren();
+		for (; loadedHierarchyNodes < children.Size(); ++loadedHierarchyNodes)
+		{
+			Node* node = children[loadedHierarchyNodes];
+			if (hierarchyWindow->GetShowTemporaryObject() || !node->IsTemporary())
+				hierarchyWindow->UpdateHierarchyItem(node);
+		}
+	}
+
+	void EPScene3D::ShowLoadProgress(float progress, unsigned loadedNodes, unsigned totalNodes)
+	{
+		if (loadProgress.Null())
+		{
+			Font* font = cache_->GetResource<Font>("Fonts/Anonymous Pro.ttf");
+
+			loadProgress = new BorderImage(context_);
+			loadProgress->SetName("LoadProgress");
+			loadProgress->SetDefaultStyle(editorData_->GetDefaultStyle());
+			loadProgress->SetStyle("EditorToolBar");
+			loadProgress->SetLayout(LM_HORIZONTAL, 6, IntRect(8, 6, 8, 6));
+			loadProgress->SetAlignment(HA_CENTER, VA_CENTER);
+			loadProgress->SetPriority(200);
+
+			BorderImage* track = loadProgress->CreateChild<BorderImage>("LoadProgressTrack");
+			track->SetFixedSize(LOAD_PROGRESS_WIDTH, 12);
+			track->SetColor(Color(0.1f, 0.1f, 0.1f, 0.8f));
+			loadProgressBar = track->CreateChild<BorderImage>("LoadProgressBar");
+			loadProgressBar->SetColor(Color(0.4f, 0.6f, 1.0f));
+			loadProgressBar->SetSize(0, 12);
+
+			loadProgressText = loadProgress->CreateChild<Text>("LoadProgressText");
+			loadProgressText->SetFont(font, 11);
+			loadProgressText->SetVerticalAlignment(VA_CENTER);
+
+			Button* cancelButton = loadProgress->CreateChild<Button>("LoadCancelButton");
+			cancelButton->SetStyleAuto();
+			cancelButton->SetFixedSize(60, 18);
+			Text* cancelText = cancelButton->CreateChild<Text>();
+			cancelText->SetFont(font, 11);
+			cancelText->SetAlignment(HA_CENTER, VA_CENTER);
+			cancelText->SetText("Cancel");
+			SubscribeToEvent(cancelButton, E_RELEASED, HANDLER(EPScene3D, HandleCancelLoadScene));
+		}
+
+		activeView->AddChild(loadProgress);
+		loadProgress->SetVisible(true);
+		loadProgressBar->SetSize((int)(Clamp(progress, 0.0f, 1.0f) * (float)LOAD_PROGRESS_WIDTH), 12);
+		if (totalNodes)
+			loadProgressText->SetText("Loading " + GetFileNameAndExtension(loadingFileName) + "  " + String(loadedNodes) + "/" + String(totalNodes) + " nodes");
+		else
+			loadProgressText->SetText("Loading " + GetFileNameAndExtension(loadingFileName) + "  resources");
+	}
+
+	void EPScene3D::HandleAsyncLoadProgress(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace AsyncLoadProgress;
+
+		unsigned loadedNodes = eventData[P_LOADEDNODES].GetInt();
+		ShowLoadProgress(eventData[P_PROGRESS].GetFloat(), loadedNodes, eventData[P_TOTALNODES].GetInt());
+		if (loadedNodes)
+			AddLoadedHierarchyNodes();
+	}
 
-		return loaded;
+	void EPScene3D::HandleAsyncLoadFinished(StringHash eventType, VariantMap& eventData)
+	{
+		LOGINFOF("Loaded scene %s in %.1f s", loadingFileName.CString(), (float)loadTimer.GetUSec(false) / 1000000.0f);
+		FinishLoadScene();
+	}
+
+	void EPScene3D::HandleCancelLoadScene(StringHash eventType, VariantMap& eventData)
+	{
+		CancelLoadScene();
+
+		// Leave an empty scene rather than a partly loaded one
+		sceneModified = false;
+		ResetScene();
+		GetSubsystem<ResourceRetention>()->Trim();
 	}
 
 	bool EPScene3D::SaveScene(const String& fileName)
@@ -1507,24 +2343,33 @@ namespace Urho3D
 		if (fileName.Empty())
 			return false;
 
-		ui_->GetCursor()->SetShape(CS_BUSY);
+		// A partly loaded scene would overwrite the file with fewer nodes
+		if (IsLoadingScene())
+		{
+			LOGWARNINGF("Scene %s is still loading, not saving it to %s", loadingFileName.CString(), fileName.CString());
+
+			MessageBox(context_, "The scene is still loading.\nSave it once loading has finished.");
+			return false;
+		}
+
+		if (!sceneSaver)
+		{
+			sceneSaver = new SceneSaver(context_);
+			SubscribeToEvent(sceneSaver, E_SCENESAVEFINISHED, HANDLER(EPScene3D, HandleSceneSaveFinished));
+		}
 
 		// Unpause when saving so that the scene will work properly when loaded outside the editor
 		editorData_->GetEditorScene()->SetUpdateEnabled(true);
 
-		MakeBackup(fileName);
-		File file(context_, fileName, FILE_WRITE);
-		String extension = GetExtension(fileName);
-		bool success = (extension != ".xml" ? editorData_->GetEditorScene()->Save(file) : editorData_->GetEditorScene()->SaveXML(file));
-		RemoveBackup(success, fileName);
+		// Only the serialization runs here, the file is written in the background
+		bool success = sceneSaver->Save(editorData_->GetEditorScene(), fileName);
 
 		editorData_->GetEditorScene()->SetUpdateEnabled(false);
 
 		if (success)
 		{
-			//	UpdateSceneMru(fileName);
+			// Changes made while the file is written mark the scene modified again
 			sceneModified = false;
-			//	UpdateWindowTitle();
 		}
 		else
 			MessageBox(context_, "Could not save scene successfully!\nSee Urho3D.log for more detail.");
@@ -1532,9 +2377,20 @@ namespace Urho3D
 		return success;
 	}
 
+	void EPScene3D::HandleSceneSaveFinished(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace SceneSaveFinished;
+
+		if (!eventData[P_SUCCESS].GetBool())
+		{
+			sceneModified = true;
+			MessageBox(context_, "Could not save scene successfully!\nSee Urho3D.log for more detail.");
+		}
+	}
+
 	Node* EPScene3D::LoadNode(const String& fileName, Node* parent /*= NULL*/)
 	{
-		if (fileName.Empty())
+		if (fileName.Empty() || IsLoadingScene())
 			return NULL;
 
 		if (!fileSystem_->FileExists(fileName))
@@ -1570,7 +2426,7 @@ namespace Urho3D
 
 	bool EPScene3D::SaveNode(const String& fileName)
 	{
-		if (fileName.Empty())
+		if (fileName.Empty() || IsLoadingScene())
 			return false;
 
 		ui_->GetCursor()->SetShape(CS_BUSY);
@@ -1650,6 +2506,9 @@ namespace Urho3D
 
 	Node* EPScene3D::CreateNode(CreateMode mode)
 	{
+		if (IsLoadingScene())
+			return NULL;
+
 		Node* newNode = NULL;
 		if (editorSelection_->GetEditNode() != NULL)
 			newNode = editorSelection_->GetEditNode()->CreateChild("", mode);
@@ -1672,6 +2531,9 @@ namespace Urho3D
 
 	void EPScene3D::CreateComponent(const String& componentType)
 	{
+		if (IsLoadingScene())
+			return;
+
 		// If this is the root node, do not allow to create duplicate scene-global components
 		if (editorSelection_->GetEditNode() == editorData_->GetEditorScene() && CheckForExistingGlobalComponent(editorSelection_->GetEditNode(), componentType))
 			return;
@@ -1708,6 +2570,9 @@ namespace Urho3D
 
 	void EPScene3D::CreateBuiltinObject(const String& name)
 	{
+		if (IsLoadingScene())
+			return;
+
 		Node* newNode = editorData_->GetEditorScene()->CreateChild(name, REPLICATED);
 		// Set the new node a certain distance from the camera
 		//	newNode.position = GetNewNodePosition();
@@ -2084,6 +2949,8 @@ namespace Urho3D
 	{
 		if (grid_ != NULL)
 			grid_->SetEnabled(false);
+		if (gridAxes_ != NULL)
+			gridAxes_->SetEnabled(false);
 	}
 
 	void EPScene3D::ShowGrid()
@@ -2091,15 +2958,23 @@ namespace Urho3D
 		if (grid_ != NULL)
 		{
 			grid_->SetEnabled(true);
+			gridAxes_->SetEnabled(true);
 
 			EditorData* editorData_ = GetSubsystem<EditorData>();
-			if (editorData_->GetEditorScene()->GetComponent<Octree>() != NULL)
-				editorData_->GetEditorScene()->GetComponent<Octree>()->AddManualDrawable(grid_);
+			Octree* octree = editorData_->GetEditorScene()->GetComponent<Octree>();
+			if (octree != NULL)
+			{
+				octree->AddManualDrawable(grid_);
+				octree->AddManualDrawable(gridAxes_);
+			}
 		}
 	}
 
 	void EPScene3D::StartSceneUpdate()
 	{
+		if (IsLoadingScene())
+			return;
+
 		runUpdate = true;
 		// Run audio playback only when scene is updating, so that audio components' time-dependent attributes stay constant when
 		// paused (similar to physics)
@@ -2107,14 +2982,15 @@ namespace Urho3D
 		toolBarDirty = true;
 
 		// Save scene data for reverting if enabled
+		if (!revertSnapshot)
+			revertSnapshot = new SceneSnapshot(context_);
+		revertSnapshot->Clear();
 		if (revertOnPause)
-		{
-			revertData = new XMLFile(context_);
-			XMLElement root = revertData->CreateRoot("scene");
-			editorData_->GetEditorScene()->SaveXML(root);
-		}
-		else
-			revertData = NULL;
+			revertSnapshot->Take(editorData_->GetEditorScene());
+
+		// The simulation changes the scene every frame, none of it is worth recovering
+		if (autosaveJournal)
+			autosaveJournal->Pause();
 	}
 
 	void EPScene3D::StopSceneUpdate()
@@ -2124,19 +3000,35 @@ namespace Urho3D
 		toolBarDirty = true;
 
 		// If scene should revert on update stop, load saved data now
-		if (revertOnPause && revertData.NotNull())
+		bool reverted = revertOnPause && revertSnapshot && revertSnapshot->IsValid();
+		if (reverted)
 		{
-			editor_->GetHierarchyWindow()->SetSuppressSceneChanges(true);
-		
-			editorData_->GetEditorScene()->Clear();
-			editorData_->GetEditorScene()->LoadXML(revertData->GetRoot());
-			CreateGrid();
-			editor_->GetHierarchyWindow()->UpdateHierarchyItem(editorData_->GetEditorScene(), true);
-			//ClearEditActions();
-			editor_->GetHierarchyWindow()->SetSuppressSceneChanges(false);
+			// Restoring only the changes updates the affected hierarchy rows through the scene events
+			if (revertSnapshot->CanRevertIncrementally())
+				revertSnapshot->RevertIncremental();
+			else
+			{
+				editor_->GetHierarchyWindow()->SetSuppressSceneChanges(true);
+
+				revertSnapshot->RevertFull();
+				CreateGrid();
+				editor_->GetHierarchyWindow()->UpdateHierarchyItem(editorData_->GetEditorScene(), true);
+				//ClearEditActions();
+				editor_->GetHierarchyWindow()->SetSuppressSceneChanges(false);
+			}
 		}
 
-		revertData = NULL;
+		if (revertSnapshot)
+			revertSnapshot->Clear();
+
+		// A reverted scene matches the journal again, otherwise the simulated state becomes the new snapshot
+		if (autosaveJournal && autosaveJournal->IsPaused())
+		{
+			if (reverted)
+				autosaveJournal->Resume();
+			else
+				autosaveJournal->Track(editorData_->GetEditorScene());
+		}
 	}
 
 	void EPScene3D::CreateGrid()
@@ -2144,12 +3036,27 @@ namespace Urho3D
 		ResourceCache* cache = GetSubsystem<ResourceCache>();
 		if (!gridNode_)
 		{
+			Material* material = cache->GetResource<Material>("Materials/VColUnlit.xml");
+
 			gridNode_ = new Node(context_);
 			grid_ = gridNode_->CreateComponent<CustomGeometry>();
 			grid_->SetNumGeometries(1);
-			grid_->SetMaterial(cache->GetResource<Material>("Materials/VColUnlit.xml"));
+			grid_->SetMaterial(material);
 			grid_->SetViewMask(0x80000000); // Editor raycasts use viewmask 0x7fffffff
 			grid_->SetOccludee(false);
+
+			gridAxesNode_ = new Node(context_);
+			gridAxes_ = gridAxesNode_->CreateComponent<CustomGeometry>();
+			gridAxes_->SetNumGeometries(1);
+			gridAxes_->SetViewMask(0x80000000);
+			gridAxes_->SetOccludee(false);
+			// The axes overlap a grid line, bias them towards the camera so they always win the depth test
+			if (material)
+			{
+				SharedPtr<Material> axesMaterial = material->Clone();
+				axesMaterial->SetDepthBias(BiasParameters(-0.00001f, 0.0f));
+				gridAxes_->SetMaterial(axesMaterial);
+			}
 		}
 		UpdateGrid();
 	}
@@ -2157,65 +3064,136 @@ namespace Urho3D
 	void EPScene3D::UpdateGrid(bool updateGridGeometry /*= true*/)
 	{
 		showGrid_ ? ShowGrid() : HideGrid();
-		gridNode_->SetScale(Vector3(8.0f, 8.0f, 8.0f));
 
 		if (!updateGridGeometry)
 			return;
 
-		unsigned int size = unsigned int(floor(8.0f / 2.0f) * 2.0f);
-		float halfSizeScaled = size / 2.0f;
-		float scale = 1.0f;
-		unsigned int subdivisionSize = unsigned int(pow(2.0f, 3.0f));
-
-		if (subdivisionSize > 0)
+		unsigned hash = grid2DMode_ ? 2 : 1;
+		hash = hash * 31 + gridColor.ToUInt();
+		hash = hash * 31 + gridSubdivisionColor.ToUInt();
+		hash = hash * 31 + gridXColor.ToUInt();
+		hash = hash * 31 + gridYColor.ToUInt();
+		hash = hash * 31 + gridZColor.ToUInt();
+		if (hash == gridGeometryHash_)
 		{
-			size *= subdivisionSize;
-			scale /= subdivisionSize;
+			UpdateGridPlacement();
+			return;
 		}
+		gridGeometryHash_ = hash;
 
-		unsigned int halfSize = size / 2;
+		// Unit cells around the origin, the node transform sets the cell size and follows the camera
+		int halfSize = GRID_CELLS / 2;
+		float halfSizeScaled = (float)halfSize;
 
 		grid_->BeginGeometry(0, LINE_LIST);
-		float lineOffset = -halfSizeScaled;
-		for (unsigned int i = 0; i <= size; ++i)
+		for (int i = -halfSize; i <= halfSize; ++i)
 		{
-			bool lineCenter = i == halfSize;
-			bool lineSubdiv = !Equals(float(i% subdivisionSize), 0.0f);
+			float lineOffset = (float)i;
+			const Color& color = i % (int)GRID_SUBDIVISIONS ? gridSubdivisionColor : gridColor;
 
 			if (!grid2DMode_)
 			{
 				grid_->DefineVertex(Vector3(lineOffset, 0.0, halfSizeScaled));
-				grid_->DefineColor(lineCenter ? gridZColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 				grid_->DefineVertex(Vector3(lineOffset, 0.0, -halfSizeScaled));
-				grid_->DefineColor(lineCenter ? gridZColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 
 				grid_->DefineVertex(Vector3(-halfSizeScaled, 0.0, lineOffset));
-				grid_->DefineColor(lineCenter ? gridXColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 				grid_->DefineVertex(Vector3(halfSizeScaled, 0.0, lineOffset));
-				grid_->DefineColor(lineCenter ? gridXColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 			}
 			else
 			{
 				grid_->DefineVertex(Vector3(lineOffset, halfSizeScaled, 0.0));
-				grid_->DefineColor(lineCenter ? gridYColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 				grid_->DefineVertex(Vector3(lineOffset, -halfSizeScaled, 0.0));
-				grid_->DefineColor(lineCenter ? gridYColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 
 				grid_->DefineVertex(Vector3(-halfSizeScaled, lineOffset, 0.0));
-				grid_->DefineColor(lineCenter ? gridXColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 				grid_->DefineVertex(Vector3(halfSizeScaled, lineOffset, 0.0));
-				grid_->DefineColor(lineCenter ? gridXColor : (lineSubdiv ? gridSubdivisionColor : gridColor));
+				grid_->DefineColor(color);
 			}
-
-			lineOffset += scale;
 		}
 		grid_->Commit();
+
+		// Unit length axes, scaled to reach past the grid
+		gridAxes_->BeginGeometry(0, LINE_LIST);
+		gridAxes_->DefineVertex(Vector3(-1.0f, 0.0f, 0.0f));
+		gridAxes_->DefineColor(gridXColor);
+		gridAxes_->DefineVertex(Vector3(1.0f, 0.0f, 0.0f));
+		gridAxes_->DefineColor(gridXColor);
+		if (!grid2DMode_)
+		{
+			gridAxes_->DefineVertex(Vector3(0.0f, 0.0f, -1.0f));
+			gridAxes_->DefineColor(gridZColor);
+			gridAxes_->DefineVertex(Vector3(0.0f, 0.0f, 1.0f));
+			gridAxes_->DefineColor(gridZColor);
+		}
+		else
+		{
+			gridAxes_->DefineVertex(Vector3(0.0f, -1.0f, 0.0f));
+			gridAxes_->DefineColor(gridYColor);
+			gridAxes_->DefineVertex(Vector3(0.0f, 1.0f, 0.0f));
+			gridAxes_->DefineColor(gridYColor);
+		}
+		gridAxes_->Commit();
+
+		UpdateGridPlacement();
+	}
+
+	void EPScene3D::UpdateGridPlacement()
+	{
+		if (!gridNode_ || !showGrid_ || !cameraNode_ || !camera_)
+			return;
+
+		Vector3 cameraPos = cameraNode_->GetWorldPosition();
+		float distance;
+		if (camera_->IsOrthographic())
+			distance = camera_->GetOrthoSize() / camera_->GetZoom() / GRID_VIEW_RANGE;
+		else
+			distance = Abs(grid2DMode_ ? cameraPos.z_ : cameraPos.y_);
+
+		// Grow the cells in whole subdivision steps, so the minor lines of a level are the major lines of the level below
+		float cellSize = GRID_MIN_CELL_SIZE;
+		while (cellSize * (GRID_CELLS / 2) < distance * GRID_VIEW_RANGE && cellSize < GRID_MAX_CELL_SIZE)
+			cellSize *= (float)GRID_SUBDIVISIONS;
+
+		// Snap to major lines, so following the camera does not move the visible lines
+		float majorSize = cellSize * GRID_SUBDIVISIONS;
+		Vector3 center(floorf(cameraPos.x_ / majorSize + 0.5f) * majorSize, 0.0f, 0.0f);
+		if (grid2DMode_)
+			center.y_ = floorf(cameraPos.y_ / majorSize + 0.5f) * majorSize;
+		else
+			center.z_ = floorf(cameraPos.z_ / majorSize + 0.5f) * majorSize;
+
+		if (gridNode_->GetPosition() != center || gridNode_->GetScale().x_ != cellSize)
+		{
+			gridNode_->SetPosition(center);
+			gridNode_->SetScale(cellSize);
+
+			float axesLength = Max(Abs(center.x_), Abs(grid2DMode_ ? center.y_ : center.z_)) + cellSize * (GRID_CELLS / 2);
+			gridAxesNode_->SetScale(axesLength);
+		}
 	}
 
 	EPScene3DView::EPScene3DView(Context* context) : BorderImage(context),
 		ownScene_(true),
 		rttFormat_(Graphics::GetRGBFormat()),
 		autoUpdate_(true),
+		updateQueued_(true),
+		pendingUpdate_(false),
+		updateInterval_(0.0f),
+		updateTimer_(0.0f),
+		resizePending_(false),
+		resizeTimer_(0.0f),
+		dynamicResolution_(false),
+		targetFrameTime_(1.0f / 30.0f),
+		renderScale_(1.0f),
+		settleTimer_(0.0f),
+		skippedFrames_(0),
+		frames_(0),
 		cameraYaw_(0.0f),
 		cameraPitch_(0.0f)
 	{
@@ -2250,22 +3228,51 @@ namespace Urho3D
 
 		if (width > 0 && height > 0)
 		{
-			renderTexture_->SetSize(width, height, rttFormat_, TEXTURE_RENDERTARGET);
-			depthTexture_->SetSize(width, height, Graphics::GetDepthStencilFormat(), TEXTURE_DEPTHSTENCIL);
-			RenderSurface* surface = renderTexture_->GetRenderSurface();
-			surface->SetViewport(0, viewport_);
-			surface->SetUpdateMode(autoUpdate_ ? SURFACE_UPDATEALWAYS : SURFACE_MANUALUPDATE);
-			surface->SetLinkedDepthStencil(depthTexture_->GetRenderSurface());
+			int texWidth = renderTexture_->GetWidth();
+			int texHeight = renderTexture_->GetHeight();
+
+			// Keep the textures while the view fits into them, a larger or much smaller view reallocates once the size settles
+			if (texWidth <= 0 || texHeight <= 0)
+				AllocateRenderTarget(width, height);
+			else if (texWidth < width || texHeight < height ||
+				texWidth > GetRenderTargetSize(width) + RENDER_TARGET_BUCKET * 2 || texHeight > GetRenderTargetSize(height) + RENDER_TARGET_BUCKET * 2)
+			{
+				resizePending_ = true;
+				resizeTimer_ = 0.0f;
+			}
+			else
+				resizePending_ = false;
 
-			SetTexture(renderTexture_);
-			SetImageRect(IntRect(0, 0, width, height));
+			ApplyRenderScale();
 
-			if (!autoUpdate_)
+			RenderSurface* surface = renderTexture_->GetRenderSurface();
+			if (!autoUpdate_ && surface)
 				surface->QueueUpdate();
 		}
 		HandleResize();
 	}
 
+	int EPScene3DView::GetRenderTargetSize(int size)
+	{
+		return (size + RENDER_TARGET_BUCKET - 1) / RENDER_TARGET_BUCKET * RENDER_TARGET_BUCKET;
+	}
+
+	void EPScene3DView::AllocateRenderTarget(int width, int height)
+	{
+		width = GetRenderTargetSize(width);
+		height = GetRenderTargetSize(height);
+
+		renderTexture_->SetSize(width, height, rttFormat_, TEXTURE_RENDERTARGET);
+		depthTexture_->SetSize(width, height, Graphics::GetDepthStencilFormat(), TEXTURE_DEPTHSTENCIL);
+		RenderSurface* surface = renderTexture_->GetRenderSurface();
+		surface->SetViewport(0, viewport_);
+		surface->SetUpdateMode(autoUpdate_ ? SURFACE_UPDATEALWAYS : SURFACE_MANUALUPDATE);
+		surface->SetLinkedDepthStencil(depthTexture_->GetRenderSurface());
+
+		SetTexture(renderTexture_);
+		resizePending_ = false;
+	}
+
 	void EPScene3DView::OnHover(const IntVector2& position, const IntVector2& screenPosition, int buttons, int qualifiers, Cursor* cursor)
 	{
 		UIElement::OnHover(position, screenPosition, buttons, qualifiers, cursor);
@@ -2301,6 +3308,8 @@ namespace Urho3D
 		if (format != rttFormat_)
 		{
 			rttFormat_ = format;
+			if (GetWidth() > 0 && GetHeight() > 0)
+				AllocateRenderTarget(GetWidth(), GetHeight());
 			OnResize();
 		}
 	}
@@ -2320,6 +3329,16 @@ namespace Urho3D
 	{
 		if (!autoUpdate_)
 		{
+			// Throttled views collect the request and update once the interval has passed
+			if (updateTimer_ < updateInterval_)
+			{
+				pendingUpdate_ = true;
+				return;
+			}
+
+			updateTimer_ = 0.0f;
+			pendingUpdate_ = false;
+			updateQueued_ = true;
 			RenderSurface* surface = renderTexture_->GetRenderSurface();
 			if (surface)
 				surface->QueueUpdate();
@@ -2493,6 +3512,60 @@ namespace Urho3D
 		statusBar->SetFixedSize(GetWidth(), 22);
 	}
 
+	void EPScene3DView::SetDynamicResolution(bool enable)
+	{
+		dynamicResolution_ = enable;
+		if (!enable)
+			SetRenderScale(1.0f);
+	}
+
+	void EPScene3DView::SetRenderScale(float scale)
+	{
+		// Quantize, so that small frame time jitter does not change the viewport every frame
+		scale = Clamp((float)(int)(scale * RENDER_SCALE_STEPS + 0.5f) / RENDER_SCALE_STEPS, MIN_RENDER_SCALE, 1.0f);
+		if (scale == renderScale_)
+			return;
+
+		renderScale_ = scale;
+		ApplyRenderScale();
+		QueueUpdate();
+	}
+
+	void EPScene3DView::ApplyRenderScale()
+	{
+		int width = GetWidth();
+		int height = GetHeight();
+		int texWidth = renderTexture_->GetWidth();
+		int texHeight = renderTexture_->GetHeight();
+		if (width <= 0 || height <= 0 || texWidth <= 0 || texHeight <= 0)
+			return;
+
+		// Render into the top left part of the texture and stretch it over the element. While a reallocation is pending the
+		// view may be larger than the texture, then the rendered area shrinks to fit, keeping the aspect ratio
+		float scale = Min(renderScale_, Min((float)texWidth / (float)width, (float)texHeight / (float)height));
+		IntRect rect(0, 0, Clamp((int)(width * scale), 1, texWidth), Clamp((int)(height * scale), 1, texHeight));
+		viewport_->SetRect(rect);
+		SetImageRect(rect);
+	}
+
+	void EPScene3DView::UpdateRenderScale(float timeStep, bool cameraMoved)
+	{
+		if (cameraMoved)
+		{
+			settleTimer_ = 0.0f;
+			if (timeStep > targetFrameTime_ * 1.1f)
+				SetRenderScale(renderScale_ * 0.85f);
+			else if (timeStep < targetFrameTime_ * 0.7f)
+				SetRenderScale(renderScale_ + 1.0f / RENDER_SCALE_STEPS);
+		}
+		else if (renderScale_ < 1.0f)
+		{
+			settleTimer_ += timeStep;
+			if (settleTimer_ >= RENDER_SCALE_SETTLE_TIME)
+				SetRenderScale(1.0f);
+		}
+	}
+
 	void EPScene3DView::HandleSettingsLineEditTextChange(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace TextChanged;
@@ -2546,6 +3619,40 @@ namespace Urho3D
 
 	void EPScene3DView::Update(float timeStep)
 	{
+		if (resizePending_)
+		{
+			resizeTimer_ += timeStep;
+			if (resizeTimer_ >= RESIZE_SETTLE_TIME && GetWidth() > 0 && GetHeight() > 0)
+			{
+				AllocateRenderTarget(GetWidth(), GetHeight());
+				ApplyRenderScale();
+				if (!autoUpdate_)
+					renderTexture_->GetRenderSurface()->QueueUpdate();
+			}
+		}
+
+		updateTimer_ += timeStep;
+		if (pendingUpdate_ && updateTimer_ >= updateInterval_)
+			QueueUpdate();
+
+		// Camera movement, zoom and projection changes always need a redraw
+		Matrix3x4 view = camera_->GetView();
+		Matrix4 projection = camera_->GetProjection();
+		bool cameraMoved = view != lastView_ || projection != lastProjection_;
+		if (cameraMoved)
+		{
+			lastView_ = view;
+			lastProjection_ = projection;
+			QueueUpdate();
+		}
+		if (dynamicResolution_)
+			UpdateRenderScale(timeStep, cameraMoved);
+
+		++frames_;
+		if (!autoUpdate_ && !updateQueued_)
+			++skippedFrames_;
+		updateQueued_ = false;
+
 		Vector3 cameraPos = cameraNode_->GetPosition();
 		String xText(cameraPos.x_);
 		String yText(cameraPos.y_);
@@ -6,6 +6,12 @@
 #include "UIGlobals.h"
 #include "..\UI\UIElement.h"
 #include "..\Scene\Node.h"
+#include "..\Math\Ray.h"
+#include "..\Math\Matrix3x4.h"
+#include "..\Math\BoundingBox.h"
+#include "..\Graphics\DebugRenderer.h"
+#include "..\Container\HashSet.h"
+#include "..\Core\Timer.h"
 
 namespace Urho3D
 {
@@ -37,6 +43,13 @@ namespace Urho3D
 		SNAP_SCALE_QUARTER
 	};
 
+	enum ViewportLayout
+	{
+		VIEWPORT_SINGLE = 0,
+		VIEWPORT_SPLIT,
+		VIEWPORT_QUAD
+	};
+
 	class Window;
 	class View3D;
 	class Camera;
@@ -49,6 +62,9 @@ namespace Urho3D
 	class EditorView;
 	class EditorSelection;
 	class DebugRenderer;
+	class SceneSnapshot;
+	class SceneSaver;
+	class SceneJournal;
 	class UI;
 	class Input;
 	class SoundListener;
@@ -68,6 +84,7 @@ namespace Urho3D
 
 	class EPScene3D;
 	class GizmoScene3D;
+	class EditorPicking;
 
 	class EPScene3DView : public BorderImage
 	{
@@ -99,6 +116,24 @@ namespace Urho3D
 		void SetAutoUpdate(bool enable);
 		/// Queue manual update on the render texture.
 		void QueueUpdate();
+		/// Return number of frames the render texture was not updated since the last reset.
+		unsigned GetNumSkippedFrames() const { return skippedFrames_; }
+		/// Return number of frames since the last reset.
+		unsigned GetNumFrames() const { return frames_; }
+		/// Reset the frame counters.
+		void ResetFrameCounters() { skippedFrames_ = 0; frames_ = 0; }
+		/// Set minimum time between manual updates, later queued updates wait for it. Zero updates immediately.
+		void SetUpdateInterval(float interval) { updateInterval_ = interval; }
+		/// Return minimum time between manual updates.
+		float GetUpdateInterval() const { return updateInterval_; }
+		/// Set whether to lower the render resolution while the camera moves.
+		void SetDynamicResolution(bool enable);
+		/// Set frame time the dynamic resolution tries to hold.
+		void SetTargetFrameTime(float time) { targetFrameTime_ = time; }
+		/// Return whether dynamic resolution is enabled.
+		bool GetDynamicResolution() const { return dynamicResolution_; }
+		/// Return current render resolution scale.
+		float GetRenderScale() const { return renderScale_; }
 
 		/// Return render texture pixel format.
 		unsigned GetFormat() const { return rttFormat_; }
@@ -131,6 +166,16 @@ namespace Urho3D
 		void SetOrthographic(bool orthographic);
 
 		void HandleResize();
+		/// (Re)create the render and depth textures for a view size, rounded up to the allocation bucket.
+		void AllocateRenderTarget(int width, int height);
+		/// Return the render target size allocated for a view size.
+		static int GetRenderTargetSize(int size);
+		/// Set render resolution scale, quantized and clamped to the allowed range.
+		void SetRenderScale(float scale);
+		/// Apply the render scale to the viewport and image rectangles.
+		void ApplyRenderScale();
+		/// Adjust the render scale from the frame time while the camera moves, restore it once the camera settles.
+		void UpdateRenderScale(float timeStep, bool cameraMoved);
 
 		void HandleSettingsLineEditTextChange(StringHash eventType, VariantMap& eventData);
 		void HandleOrthographicToggled(StringHash eventType, VariantMap& eventData);
@@ -164,6 +209,34 @@ namespace Urho3D
 		unsigned rttFormat_;
 		/// Render texture auto update mode.
 		bool autoUpdate_;
+		/// Manual update queued for this frame.
+		bool updateQueued_;
+		/// Update queued while the update interval had not passed yet.
+		bool pendingUpdate_;
+		/// Minimum time between manual updates.
+		float updateInterval_;
+		/// Time since the last manual update.
+		float updateTimer_;
+		/// Camera view at the last update, to detect camera movement.
+		Matrix3x4 lastView_;
+		/// Camera projection at the last update.
+		Matrix4 lastProjection_;
+		/// Render target reallocation waits for the view size to settle.
+		bool resizePending_;
+		/// Time since the last resize.
+		float resizeTimer_;
+		/// Lower the render resolution while the camera moves.
+		bool dynamicResolution_;
+		/// Frame time to hold while moving.
+		float targetFrameTime_;
+		/// Fraction of the view size rendered.
+		float renderScale_;
+		/// Time since the camera last moved.
+		float settleTimer_;
+		/// Frames without a render texture update.
+		unsigned skippedFrames_;
+		/// Frames counted.
+		unsigned frames_;
 		/// ui stuff
 		SharedPtr<UIElement>statusBar;
 		SharedPtr<Text> cameraPosText;
@@ -210,6 +283,17 @@ namespace Urho3D
 		void ResetCamera();
 		void ReacquireCameraYawPitch();
 		void UpdateViewParameters();
+		// viewport handling
+		/// Switch between one, two and four view panes.
+		void SetViewportLayout(ViewportLayout layout);
+		/// Make a view pane receive input, picking and the stats bar.
+		void SetActiveView(EPScene3DView* view);
+		/// Set the minimum time between redraws of the inactive view panes, 0 redraws them on every change.
+		void SetInactiveViewUpdateInterval(float interval);
+		/// Return the minimum time between redraws of the inactive view panes.
+		float GetInactiveViewUpdateInterval() const { return inactiveViewUpdateInterval; }
+		/// Queue a redraw of all view panes.
+		void QueueViewUpdates();
 		// grid
 		void HideGrid();
 		void ShowGrid();
@@ -227,7 +311,10 @@ namespace Urho3D
 		void SetFillMode(FillMode fM_);
 
 		Vector3 SelectedNodesCenterPoint();
-		void	DrawNodeDebug(Node* node, DebugRenderer* debug, bool drawNode = true);
+		/// Draw the selected nodes in the frustum. Near components get their debug geometry until the draw time budget is used up, the rest a bounding box up to the box limit. The component and box list is collected again when the selection, the pick modification count or the simulation changes it.
+		void	DrawSelectionDebug(DebugRenderer* debug);
+		/// Add the components of a node and its children to the selection debug items.
+		void	CollectNodeDebug(Node* node, unsigned depth);
 		void	MakeBackup(const String& fileName);
 		void	RemoveBackup(bool success, const String& fileName);
 
@@ -235,11 +322,35 @@ namespace Urho3D
 		bool MoveNodes(Vector3 adjust);
 		bool RotateNodes(Vector3 adjust);
 		bool ScaleNodes(Vector3 adjust);
+		/// Collect the edit nodes without an edited ancestor into transformRoots, transforming those moves the rest.
+		void CollectTransformRoots();
+		/// Apply pendingTransforms with one transform update per node. Return true if any node changed.
+		bool CommitTransforms();
 
 		/// Picking
 		void ViewRaycast(bool mouseClick);
 		void SelectComponent(Component* component, bool multiselect);
 		void SelectNode(Node* node, bool multiselect);
+		/// Select many nodes with a single hierarchy selection update.
+		void SelectNodes(const PODVector<Node*>& nodes, bool multiselect);
+		/// Track the marquee drag and apply it when the mouse button is released.
+		void UpdateMarquee();
+		/// Select the nodes of all pickable drawables inside a screen rectangle.
+		void MarqueeSelect(const IntVector2& min, const IntVector2& max, bool multiselect);
+		/// Log BVH and octree pick timings for a ray through the view center.
+		void BenchmarkPicking();
+		/// Switch between redrawing the view every frame and only when something changed.
+		void SetRenderOnDemand(bool enable);
+		/// Create a view pane showing the editor scene.
+		EPScene3DView* CreateView();
+		/// Reset the camera of a view pane: perspective for the first pane, top, front and side orthographic for the others.
+		void ResetViewCamera(unsigned index);
+		/// Position the view panes inside the main screen.
+		void LayoutViews();
+		/// Apply the update modes: the active pane follows render on demand, the others redraw only on change at a reduced rate.
+		void UpdateViewModes();
+		/// Queue a redraw of the view in render on demand mode.
+		void HandleViewChanged(StringHash eventType, VariantMap& eventData);
 
 		/// mouse handling
 		void SetMouseMode(bool enable);
@@ -247,6 +358,7 @@ namespace Urho3D
 		void ReleaseMouseLock();
 
 		/// Engine Events Handling
+		void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
 		void HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData);
 		void ViewMouseClick(StringHash eventType, VariantMap& eventData);
 		void ViewMouseMove(StringHash eventType, VariantMap& eventData);
@@ -261,6 +373,8 @@ namespace Urho3D
 		void HandleMenuBarAction(StringHash eventType, VariantMap& eventData);
 		/// messageBox
 		void HandleMessageAcknowledgement(StringHash eventType, VariantMap& eventData);
+		/// Restore the autosaved scene of a crashed session if confirmed.
+		void HandleAutosaveRecovery(StringHash eventType, VariantMap& eventData);
 
 		// Menu Bar actions
 		/// create new scene, because we use only one scene reset it ...
@@ -270,8 +384,24 @@ namespace Urho3D
 		void HandleLoadNodeFile(StringHash eventType, VariantMap& eventData);
 		void HandleSaveNodeFile(StringHash eventType, VariantMap& eventData);
 
+		/// Start loading a scene asynchronously. Return true if loading started.
 		bool LoadScene(const String& fileName);
+		/// Hide the load progress and finish the hierarchy, camera and grid once the scene is loaded.
+		void FinishLoadScene();
+		/// Stop an asynchronous load, the partly loaded scene is left as is.
+		void CancelLoadScene();
+		/// Return whether a scene is loading. Until it finishes the scene is neither edited nor saved.
+		bool IsLoadingScene() const;
+		/// Add the root level nodes loaded since the last call to the hierarchy.
+		void AddLoadedHierarchyNodes();
+		/// Show the load progress bar over the active view.
+		void ShowLoadProgress(float progress, unsigned loadedNodes, unsigned totalNodes);
+		void HandleAsyncLoadProgress(StringHash eventType, VariantMap& eventData);
+		void HandleAsyncLoadFinished(StringHash eventType, VariantMap& eventData);
+		void HandleCancelLoadScene(StringHash eventType, VariantMap& eventData);
+		/// Serialize the scene and write it in the background. Return true if the write started.
 		bool SaveScene(const String& fileName);
+		void HandleSceneSaveFinished(StringHash eventType, VariantMap& eventData);
 		Node* LoadNode(const String& fileName, Node* parent = NULL);
 		bool SaveNode(const String& fileName);
 		Node* InstantiateNodeFromFile(File* file, const Vector3& position, const Quaternion& rotation, float scaleMod = 1.0f, Node* parent = NULL, CreateMode mode = REPLICATED);
@@ -313,6 +443,7 @@ namespace Urho3D
 
 		SharedPtr<UIElement>		window_;
 		SharedPtr<EPScene3DView>	activeView;
+		Vector<SharedPtr<EPScene3DView> > views_;
 		SharedPtr<Node>				cameraNode_;
 		SharedPtr<Camera>			camera_;
 
@@ -335,7 +466,13 @@ namespace Urho3D
 		/// scene update handling
 		bool	runUpdate = false;
 		bool    revertOnPause = true;
-		SharedPtr<XMLFile> revertData;
+		/// scene snapshot taken when the update starts
+		SharedPtr<SceneSnapshot> revertSnapshot;
+		/// background scene saves
+		SharedPtr<SceneSaver> sceneSaver;
+		/// crash recovery autosave journal
+		SharedPtr<SceneJournal> autosaveJournal;
+		float	autosaveInterval = 30.0f;
 		///camera handling
 		float	cameraBaseSpeed = 10.0f;
 		float	cameraBaseRotationSpeed = 0.2f;
@@ -362,6 +499,60 @@ namespace Urho3D
 		bool	octreeDebug = false;
 		/// mouse pick handling
 		int		pickMode = PICK_GEOMETRIES;
+		bool	usePickingBVH = true;
+		SharedPtr<EditorPicking> picking_;
+		/// hover pick cache, valid while the camera ray, pick mode and scene modification count are unchanged
+		bool	hoverCacheValid = false;
+		Ray		hoverRay;
+		int		hoverPickMode = PICK_GEOMETRIES;
+		unsigned hoverModificationCount = 0;
+		WeakPtr<Component> hoverSelected;
+		WeakPtr<Component> hoverHighlight;
+		unsigned hoverPickHits = 0;
+		unsigned hoverPickQueries = 0;
+		float	hoverPickHitRate = 0.0f;
+		/// batched edit node transforms, computed for all nodes before any is applied
+		struct NodeTransform
+		{
+			Node* node_;
+			Vector3 position_;
+			Quaternion rotation_;
+			Vector3 scale_;
+		};
+		PODVector<Node*> transformRoots;
+		HashSet<Node*> transformEditNodes;
+		PODVector<NodeTransform> pendingTransforms;
+		/// gizmo drags of at least this many nodes are previewed and applied on release
+		bool	gizmoPreview = true;
+		unsigned gizmoPreviewMinNodes = 64;
+		/// selection debug drawing, the items and their boxes are collected on selection or scene changes
+		struct SelectionDebugItem
+		{
+			/// Component to draw.
+			WeakPtr<Component> component_;
+			/// World bounding box, undefined for components without one.
+			BoundingBox box_;
+			/// The box stands in for a whole subtree.
+			bool subtree_;
+		};
+		Vector<SelectionDebugItem> selectionDebugItems;
+		bool	selectionDebugDirty = true;
+		unsigned selectionDebugModificationCount = 0;
+		unsigned selectionDebugDetailed = 0;
+		unsigned selectionDebugBoxes = 0;
+		/// render on demand: the view is only redrawn when the camera, scene, selection or gizmo changed
+		bool	renderOnDemand = true;
+		unsigned viewModificationCount = 0;
+		/// viewport layout, inactive panes redraw on change at most once per interval
+		ViewportLayout viewportLayout = VIEWPORT_SINGLE;
+		float	inactiveViewUpdateInterval = 0.25f;
+		/// adaptive resolution while the camera moves
+		bool	dynamicResolution = true;
+		float	targetFrameTime = 1.0f / 30.0f;
+		/// marquee selection
+		bool	marqueeActive = false;
+		IntVector2 marqueeStart;
+		SharedPtr<BorderImage> marqueeRect;
 		/// modes
 		EditMode editMode = EDIT_MOVE;
 		AxisMode axisMode = AXIS_WORLD;
@@ -371,9 +562,17 @@ namespace Urho3D
 		bool sceneModified;
 		String instantiateFileName;
 		CreateMode instantiateMode;
+		/// asynchronous scene loading
+		String	loadingFileName;
+		HiresTimer loadTimer;
+		unsigned loadedHierarchyNodes = 0;
+		SharedPtr<BorderImage> loadProgress;
+		SharedPtr<BorderImage> loadProgressBar;
+		SharedPtr<Text> loadProgressText;
 		/// ui stuff
 		SharedPtr<Text> editorModeText;
 		SharedPtr<Text> renderStatsText;
+		float	statsTimer = 0.0f;
 		SharedPtr<Menu>	sceneMenu_;
 		SharedPtr<Menu>	createMenu_;
 		/// cached mini tool bar buttons, to set visibility
@@ -389,10 +588,16 @@ namespace Urho3D
 		/// Grid handling \todo put it into a component or object ...
 
 		void CreateGrid();
+		/// Rebuild the grid geometry if the grid parameters changed since the last build.
 		void UpdateGrid(bool updateGridGeometry = true);
+		/// Center the grid under the active camera and pick the cell size from the camera distance.
+		void UpdateGridPlacement();
 
 		SharedPtr<Node>				gridNode_;
 		SharedPtr<CustomGeometry>	grid_;
+		/// Axis lines, kept separate so they stay at the origin while the grid follows the camera.
+		SharedPtr<Node>				gridAxesNode_;
+		SharedPtr<CustomGeometry>	gridAxes_;
 		bool	showGrid_;
 		bool	grid2DMode_;
 		Color gridColor;
@@ -400,5 +605,7 @@ namespace Urho3D
 		Color gridXColor;
 		Color gridYColor;
 		Color gridZColor;
+		/// Hash of the parameters the grid geometry was built with, 0 when not built.
+		unsigned gridGeometryHash_;
 	};
 }
@@ -50,8 +50,11 @@
 #include "../Graphics/Octree.h"
 #include "../Core/CoreEvents.h"
 #include "../UI/ListView.h"
+#include "../UI/HierarchyList.h"
 #include "../IO/FileSystem.h"
 #include "ProjectManager.h"
+#include "EditorProfiler.h"
+#include "ResourceRetention.h"
 #include "../IO/Log.h"
 
 namespace Urho3D
@@ -66,6 +69,9 @@ namespace Urho3D
 		EditorData::RegisterObject(context);
 		EditorView::RegisterObject(context);
 		EditorSelection::RegisterObject(context);
+		EditorProfiler::RegisterObject(context);
+
+		HierarchyList::RegisterObject(context);
 	}
 
 	Editor::~Editor()
@@ -127,6 +133,11 @@ namespace Urho3D
 		context_->RegisterSubsystem(new EditorSelection(context_, this));
 		editorSelection_ = GetSubsystem<EditorSelection>();
 
+		if (!GetSubsystem<EditorProfiler>())
+			context_->RegisterSubsystem(new EditorProfiler(context_));
+		if (!GetSubsystem<ResourceRetention>())
+			context_->RegisterSubsystem(new ResourceRetention(context_));
+
 		//////////////////////////////////////////////////////////////////////////
 		/// create the hierarchy editor
 		hierarchyWindow_ = new HierarchyWindow(context_);
@@ -180,6 +191,9 @@ namespace Urho3D
 	{
 		AddEditorPlugin(new EPScene3D(context_));
 		AddEditorPlugin(new EPScene2D(context_));
+
+		// With the editor UI and plugins created, everything in use belongs to the editor
+		GetSubsystem<ResourceRetention>()->SnapshotEditorResources();
 	}
 
 	void Editor::OpenProject(ProjectSettings * project)
@@ -256,6 +270,11 @@ namespace Urho3D
 		// 	revertData = null;
 		// 	StopSceneUpdate();
 
+		// Clear first, the old scene's resources stay cached for the new one within their type budgets
+		scene_->Clear();
+		ResourceRetention* retention = GetSubsystem<ResourceRetention>();
+		retention->BeginSceneSwitch();
+
 		String extension = GetExtension(fileName);
 		bool loaded;
 		if (extension != ".xml")
@@ -263,9 +282,8 @@ namespace Urho3D
 		else
 			loaded = scene_->LoadXML(file);
 
-		// Release resources which are not used by the new scene
-		/// \todo this creates an bug in the attribute inspector because the loaded xml files are released
-		cache_->ReleaseAllResources(false); 
+		// Resources the new scene does not use stay cached within their type budget for the next switch
+		retention->EndSceneSwitch();
 
 		// Always pause the scene, and do updates manually
 		scene_->SetUpdateEnabled(false);
@@ -337,44 +355,38 @@ namespace Urho3D
 		sceneRootUI_ = sceneUI;
 	}
 
-	Component* Editor::GetListComponent(UIElement* item)
+	Component* Editor::GetListComponent(const HierarchyListItem& item)
 	{
 		if (scene_.Null())
 			return NULL;
 
-		if (item == NULL)
+		if (item.type_ != ITEM_COMPONENT)
 			return NULL;
 
-		if (item->GetVar(TYPE_VAR).GetInt() != ITEM_COMPONENT)
-			return NULL;
-
-		return scene_->GetComponent(item->GetVar(COMPONENT_ID_VAR).GetUInt());
+		return scene_->GetComponent(item.id_);
 	}
 
-	Node* Editor::GetListNode(UIElement* item)
+	Node* Editor::GetListNode(const HierarchyListItem& item)
 	{
 		if (scene_.Null())
 			return NULL;
 
-		if (item == NULL)
-			return NULL;
-
-		if (item->GetVar(TYPE_VAR).GetInt() != ITEM_NODE)
+		if (item.type_ != ITEM_NODE)
 			return NULL;
 
-		return scene_->GetNode(item->GetVar(NODE_ID_VAR).GetUInt());
+		return scene_->GetNode(item.id_);
 	}
 
-	UIElement* Editor::GetListUIElement(UIElement*  item)
+	UIElement* Editor::GetListUIElement(const HierarchyListItem& item)
 	{
 		if (scene_.Null())
 			return NULL;
 
-		if (item == NULL)
+		if (item.type_ != ITEM_UI_ELEMENT)
 			return NULL;
 
-		// Get the text item's ID and use it to retrieve the actual UIElement the text item is associated to
-		return GetUIElementByID(UIUtils::GetUIElementID(item));
+		// Use the item's ID to retrieve the actual UIElement the item is associated to
+		return GetUIElementByID(Variant(item.id_));
 	}
 
 	UIElement* Editor::GetUIElementByID(const Variant& id)
@@ -472,7 +484,7 @@ namespace Urho3D
 
 	void Editor::HandleHierarchyListSelectionChange(StringHash eventType, VariantMap& eventData)
 	{
-		editorSelection_->OnHierarchyListSelectionChange(hierarchyWindow_->GetHierarchyList()->GetItems(), hierarchyWindow_->GetHierarchyList()->GetSelections());
+		editorSelection_->OnHierarchyListSelectionChange(hierarchyWindow_->GetHierarchyList());
 		/// \todo dont copy
 		attributeWindow_->GetEditNodes() = editorSelection_->GetEditNodes();
 		attributeWindow_->GetEditComponents() = editorSelection_->GetEditComponents();
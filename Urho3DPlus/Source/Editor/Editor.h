@@ -24,6 +24,7 @@ namespace Urho3D
 	class MiniToolBarUI;
 	class ToolBarUI;
 	class HierarchyWindow;
+	struct HierarchyListItem;
 	class EditorSelection;
 	class AttributeInspector;
 	class EditorData;
@@ -56,9 +57,9 @@ namespace Urho3D
 		/// Getters
 		Scene*		GetScene();
 		UIElement*	GetSceneUI() { return sceneRootUI_; }
-		Component*	GetListComponent(UIElement*  item);
-		Node*		GetListNode(UIElement*  item);
-		UIElement*	GetListUIElement(UIElement*  item);
+		Component*	GetListComponent(const HierarchyListItem& item);
+		Node*		GetListNode(const HierarchyListItem& item);
+		UIElement*	GetListUIElement(const HierarchyListItem& item);
 		UIElement*	GetUIElementByID(const Variant& id);
 		HierarchyWindow*	GetHierarchyWindow() { return hierarchyWindow_; }
 		AttributeInspector* GetAttributeWindow() { return attributeWindow_; }
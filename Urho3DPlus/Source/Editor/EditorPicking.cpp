@@ -0,0 +1,699 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "EditorPicking.h"
+#include "../Core/Timer.h"
+#include "../Scene/Node.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+#include "../Graphics/Drawable.h"
+#include "../Graphics/StaticModel.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Octree.h"
+#include "../Physics/PhysicsWorld.h"
+#include "../Physics/RigidBody.h"
+#include "../IO/Log.h"
+#include "AttributeVariableEvents.h"
+
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+
+namespace Urho3D
+{
+	/// Triangles per model BVH leaf.
+	static const unsigned MAX_TRIANGLES_PER_LEAF = 4;
+	/// Drawables per scene BVH leaf.
+	static const unsigned MAX_DRAWABLES_PER_LEAF = 2;
+	/// Below this depth splits fall back to the median, which keeps the traversal stack bounded.
+	static const unsigned MAX_BVH_DEPTH = 48;
+	/// Traversal stack size.
+	static const unsigned BVH_STACK_SIZE = 128;
+	/// Above this many moved rigid bodies a full collision update is cheaper than refreshing them one by one.
+	static const unsigned MAX_MOVED_BODIES = 1024;
+
+	ModelBVH::ModelBVH(Model* model) :
+		model_(model)
+	{
+		if (!model)
+			return;
+
+		for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+		{
+			Geometry* geometry = model->GetGeometry(i, 0);
+			if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
+				continue;
+
+			const unsigned char* vertexData;
+			const unsigned char* indexData;
+			unsigned vertexSize;
+			unsigned indexSize;
+			unsigned elementMask;
+			geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elementMask);
+
+			// Position is always the first vertex element
+			if (!vertexData || !(elementMask & MASK_POSITION))
+				continue;
+
+			if (indexData)
+			{
+				unsigned indexStart = geometry->GetIndexStart();
+				unsigned indexEnd = indexStart + geometry->GetIndexCount();
+				for (unsigned j = indexStart; j + 2 < indexEnd; j += 3)
+				{
+					for (unsigned k = 0; k < 3; ++k)
+					{
+						unsigned index = indexSize == sizeof(unsigned short) ? ((const unsigned short*)indexData)[j + k] :
+							((const unsigned*)indexData)[j + k];
+						vertices_.Push(*((const Vector3*)(&vertexData[index * vertexSize])));
+					}
+					geometries_.Push(i);
+				}
+			}
+			else
+			{
+				unsigned vertexStart = geometry->GetVertexStart();
+				unsigned vertexEnd = vertexStart + geometry->GetVertexCount();
+				for (unsigned j = vertexStart; j + 2 < vertexEnd; j += 3)
+				{
+					for (unsigned k = 0; k < 3; ++k)
+						vertices_.Push(*((const Vector3*)(&vertexData[(j + k) * vertexSize])));
+					geometries_.Push(i);
+				}
+			}
+		}
+
+		unsigned numTriangles = geometries_.Size();
+		if (!numTriangles)
+			return;
+
+		PODVector<Vector3> centroids(numTriangles);
+		order_.Resize(numTriangles);
+		for (unsigned i = 0; i < numTriangles; ++i)
+		{
+			centroids[i] = (vertices_[i * 3] + vertices_[i * 3 + 1] + vertices_[i * 3 + 2]) / 3.0f;
+			order_[i] = i;
+		}
+
+		nodes_.Reserve(numTriangles * 2 / MAX_TRIANGLES_PER_LEAF + 1);
+		BuildNode(0, numTriangles, 0, centroids);
+
+		// Store the triangles in leaf order so that a leaf reads one contiguous range
+		PODVector<Vector3> sortedVertices(vertices_.Size());
+		PODVector<unsigned> sortedGeometries(numTriangles);
+		for (unsigned i = 0; i < numTriangles; ++i)
+		{
+			unsigned src = order_[i];
+			sortedVertices[i * 3] = vertices_[src * 3];
+			sortedVertices[i * 3 + 1] = vertices_[src * 3 + 1];
+			sortedVertices[i * 3 + 2] = vertices_[src * 3 + 2];
+			sortedGeometries[i] = geometries_[src];
+		}
+		vertices_ = sortedVertices;
+		geometries_ = sortedGeometries;
+		order_.Clear();
+	}
+
+	ModelBVH::~ModelBVH()
+	{
+	}
+
+	unsigned ModelBVH::BuildNode(unsigned first, unsigned count, unsigned depth, const PODVector<Vector3>& centroids)
+	{
+		unsigned nodeIndex = nodes_.Size();
+		nodes_.Resize(nodeIndex + 1);
+
+		BoundingBox box;
+		BoundingBox centroidBox;
+		for (unsigned i = first; i < first + count; ++i)
+		{
+			unsigned triangle = order_[i];
+			box.Merge(vertices_[triangle * 3]);
+			box.Merge(vertices_[triangle * 3 + 1]);
+			box.Merge(vertices_[triangle * 3 + 2]);
+			centroidBox.Merge(centroids[triangle]);
+		}
+		nodes_[nodeIndex].box_ = box;
+
+		if (count <= MAX_TRIANGLES_PER_LEAF)
+		{
+			nodes_[nodeIndex].first_ = first;
+			nodes_[nodeIndex].count_ = count;
+			return nodeIndex;
+		}
+
+		// Split at the centroid bounds center of the longest axis
+		Vector3 size = centroidBox.Size();
+		unsigned axis = 0;
+		if (size.y_ > size.x_)
+			axis = 1;
+		if (size.z_ > size.Data()[axis])
+			axis = 2;
+		float split = centroidBox.Center().Data()[axis];
+
+		unsigned mid = first;
+		unsigned end = first + count;
+		while (mid < end)
+		{
+			if (centroids[order_[mid]].Data()[axis] < split)
+				++mid;
+			else
+			{
+				--end;
+				unsigned temp = order_[mid];
+				order_[mid] = order_[end];
+				order_[end] = temp;
+			}
+		}
+
+		if (mid == first || mid == first + count || depth >= MAX_BVH_DEPTH)
+			mid = first + count / 2;
+
+		BuildNode(first, mid - first, depth + 1, centroids);
+		unsigned right = BuildNode(mid, first + count - mid, depth + 1, centroids);
+
+		nodes_[nodeIndex].first_ = right;
+		nodes_[nodeIndex].count_ = 0;
+		return nodeIndex;
+	}
+
+	float ModelBVH::Raycast(const Ray& ray, float maxDistance, unsigned& outTriangle) const
+	{
+		outTriangle = M_MAX_UNSIGNED;
+		if (nodes_.Empty())
+			return M_INFINITY;
+
+		unsigned stack[BVH_STACK_SIZE];
+		unsigned stackSize = 0;
+		stack[stackSize++] = 0;
+		float closest = maxDistance;
+
+		while (stackSize)
+		{
+			unsigned nodeIndex = stack[--stackSize];
+			const BVHNode& node = nodes_[nodeIndex];
+			if (ray.HitDistance(node.box_) >= closest)
+				continue;
+
+			if (node.count_)
+			{
+				for (unsigned i = node.first_; i < node.first_ + node.count_; ++i)
+				{
+					float distance = ray.HitDistance(vertices_[i * 3], vertices_[i * 3 + 1], vertices_[i * 3 + 2]);
+					if (distance < closest)
+					{
+						closest = distance;
+						outTriangle = i;
+					}
+				}
+			}
+			else if (stackSize + 2 <= BVH_STACK_SIZE)
+			{
+				stack[stackSize++] = node.first_;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+
+		return outTriangle != M_MAX_UNSIGNED ? closest : M_INFINITY;
+	}
+
+	void ModelBVH::GetTriangle(unsigned index, Vector3& v0, Vector3& v1, Vector3& v2) const
+	{
+		v0 = vertices_[index * 3];
+		v1 = vertices_[index * 3 + 1];
+		v2 = vertices_[index * 3 + 2];
+	}
+
+	PickTransformListener::PickTransformListener(Context* context, EditorPicking* picking) : Component(context),
+		picking_(picking)
+	{
+	}
+
+	void PickTransformListener::OnMarkedDirty(Node* node)
+	{
+		if (picking_)
+			picking_->MarkBodyMoved(node);
+	}
+
+	EditorPicking::EditorPicking(Context* context, Scene* scene) : Object(context),
+		structureDirty_(true),
+		transformsDirty_(true),
+		modificationCount_(0),
+		physicsDirty_(true)
+	{
+		bodyListener_ = new PickTransformListener(context_, this);
+		SetScene(scene);
+
+		// Attribute edits in the inspector can move, enable or disable drawables or exchange their models
+		SubscribeToEvent(AEE_NUMBERVARCHANGED, HANDLER(EditorPicking, HandleTransformsChanged));
+		SubscribeToEvent(AEE_RESREFVARCHANGED, HANDLER(EditorPicking, HandleTransformsChanged));
+		SubscribeToEvent(AEE_BOOLVARCHANGED, HANDLER(EditorPicking, HandleTransformsChanged));
+		SubscribeToEvent(AEE_ENUMVARCHANGED, HANDLER(EditorPicking, HandleTransformsChanged));
+	}
+
+	EditorPicking::~EditorPicking()
+	{
+	}
+
+	void EditorPicking::SetScene(Scene* scene)
+	{
+		if (scene_)
+		{
+			UnsubscribeFromEvent(scene_, E_NODEADDED);
+			UnsubscribeFromEvent(scene_, E_NODEREMOVED);
+			UnsubscribeFromEvent(scene_, E_COMPONENTADDED);
+			UnsubscribeFromEvent(scene_, E_COMPONENTREMOVED);
+			UnsubscribeFromEvent(scene_, E_SCENEUPDATE);
+			UnsubscribeFromEvent(scene_, E_NODEENABLEDCHANGED);
+			UnsubscribeFromEvent(scene_, E_COMPONENTENABLEDCHANGED);
+		}
+
+		scene_ = scene;
+		entries_.Clear();
+		nodes_.Clear();
+		movedBodyNodes_.Clear();
+		physicsDirty_ = true;
+		MarkStructureDirty();
+
+		if (scene)
+		{
+			PODVector<RigidBody*> bodies;
+			scene->GetComponents<RigidBody>(bodies, true);
+			for (unsigned i = 0; i < bodies.Size(); ++i)
+				AddBodyListener(bodies[i]->GetNode());
+
+			SubscribeToEvent(scene, E_NODEADDED, HANDLER(EditorPicking, HandleSceneStructureChanged));
+			SubscribeToEvent(scene, E_NODEREMOVED, HANDLER(EditorPicking, HandleSceneStructureChanged));
+			SubscribeToEvent(scene, E_COMPONENTADDED, HANDLER(EditorPicking, HandleSceneStructureChanged));
+			SubscribeToEvent(scene, E_COMPONENTREMOVED, HANDLER(EditorPicking, HandleSceneStructureChanged));
+			// A running simulation moves drawables every frame
+			SubscribeToEvent(scene, E_SCENEUPDATE, HANDLER(EditorPicking, HandleTransformsChanged));
+			// Disabled drawables are skipped by the queries, so a cached hit on one must not be reused
+			SubscribeToEvent(scene, E_NODEENABLEDCHANGED, HANDLER(EditorPicking, HandleEnabledChanged));
+			SubscribeToEvent(scene, E_COMPONENTENABLEDCHANGED, HANDLER(EditorPicking, HandleEnabledChanged));
+		}
+	}
+
+	void EditorPicking::MarkBodyMoved(Node* node)
+	{
+		++modificationCount_;
+		if (physicsDirty_)
+			return;
+
+		if (movedBodyNodes_.Size() < MAX_MOVED_BODIES)
+			movedBodyNodes_.Insert(node->GetID());
+		else
+		{
+			movedBodyNodes_.Clear();
+			physicsDirty_ = true;
+		}
+	}
+
+	void EditorPicking::UpdatePhysicsBounds(PhysicsWorld* physicsWorld)
+	{
+		if (!physicsWorld)
+			return;
+
+		if (physicsDirty_)
+		{
+			physicsWorld->UpdateCollisions();
+			physicsDirty_ = false;
+			movedBodyNodes_.Clear();
+			return;
+		}
+
+		if (movedBodyNodes_.Empty() || !scene_)
+			return;
+
+		// Raycasts only need the broadphase bounds, the contact pairs can wait for the next simulation step
+		btDiscreteDynamicsWorld* world = physicsWorld->GetWorld();
+		PODVector<RigidBody*> bodies;
+		for (HashSet<unsigned>::ConstIterator i = movedBodyNodes_.Begin(); i != movedBodyNodes_.End(); ++i)
+		{
+			Node* node = scene_->GetNode(*i);
+			if (!node)
+				continue;
+
+			node->GetComponents<RigidBody>(bodies);
+			for (unsigned j = 0; j < bodies.Size(); ++j)
+			{
+				btRigidBody* body = bodies[j]->GetBody();
+				if (body && body->getBroadphaseHandle())
+					world->updateSingleAabb(body);
+			}
+		}
+		movedBodyNodes_.Clear();
+	}
+
+	bool EditorPicking::RaycastSingle(const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, RayQueryResult& result)
+	{
+		UpdateTree();
+
+		result.drawable_ = NULL;
+		result.node_ = NULL;
+		result.distance_ = M_INFINITY;
+
+		if (nodes_.Empty())
+			return false;
+
+		unsigned stack[BVH_STACK_SIZE];
+		unsigned stackSize = 0;
+		stack[stackSize++] = 0;
+		float closest = maxDistance;
+
+		while (stackSize)
+		{
+			unsigned nodeIndex = stack[--stackSize];
+			const PickNode& node = nodes_[nodeIndex];
+			if (ray.HitDistance(node.box_) >= closest)
+				continue;
+
+			if (node.count_)
+			{
+				for (unsigned i = node.first_; i < node.first_ + node.count_; ++i)
+				{
+					if (ray.HitDistance(entries_[i].box_) >= closest)
+						continue;
+
+					float distance = RaycastEntry(entries_[i], ray, closest, drawableFlags, viewMask, result);
+					if (distance < closest)
+						closest = distance;
+				}
+			}
+			else if (stackSize + 2 <= BVH_STACK_SIZE)
+			{
+				stack[stackSize++] = node.first_;
+				stack[stackSize++] = nodeIndex + 1;
+			}
+		}
+
+		return result.drawable_ != NULL;
+	}
+
+	float EditorPicking::RaycastEntry(PickEntry& entry, const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, RayQueryResult& result)
+	{
+		Drawable* drawable = entry.drawable_;
+		if (!drawable || !drawable->IsEnabledEffective() || !(drawable->GetDrawableFlags() & drawableFlags) ||
+			!(drawable->GetViewMask() & viewMask))
+			return M_INFINITY;
+
+		// Only plain StaticModels use the cached triangle BVH. Skinned, instanced and other drawables do their own test
+		if (drawable->GetType() == StaticModel::GetTypeStatic())
+		{
+			Model* model = static_cast<StaticModel*>(drawable)->GetModel();
+			if (model != entry.model_)
+			{
+				entry.model_ = model;
+				entry.bvh_ = GetModelBVH(model);
+			}
+
+			if (entry.bvh_)
+			{
+				const Matrix3x4& worldTransform = drawable->GetNode()->GetWorldTransform();
+				Matrix3x4 inverse = worldTransform.Inverse();
+				Ray localRay = ray.Transformed(inverse);
+
+				float localMaxDistance = M_INFINITY;
+				if (maxDistance < M_INFINITY)
+					localMaxDistance = (inverse * (ray.origin_ + ray.direction_ * maxDistance) - localRay.origin_).Length();
+
+				unsigned triangle;
+				float localDistance = entry.bvh_->Raycast(localRay, localMaxDistance, triangle);
+				if (localDistance == M_INFINITY)
+					return M_INFINITY;
+
+				// Convert back to world space, the transform may contain scale
+				Vector3 position = worldTransform * (localRay.origin_ + localRay.direction_ * localDistance);
+				float distance = (position - ray.origin_).Length();
+				if (distance >= maxDistance)
+					return M_INFINITY;
+
+				Vector3 v0, v1, v2;
+				entry.bvh_->GetTriangle(triangle, v0, v1, v2);
+				v0 = worldTransform * v0;
+				v1 = worldTransform * v1;
+				v2 = worldTransform * v2;
+
+				result.position_ = position;
+				result.normal_ = (v1 - v0).CrossProduct(v2 - v0).Normalized();
+				result.distance_ = distance;
+				result.drawable_ = drawable;
+				result.node_ = drawable->GetNode();
+				result.subObject_ = entry.bvh_->GetGeometryIndex(triangle);
+				return distance;
+			}
+		}
+
+		fallbackResults_.Clear();
+		RayOctreeQuery query(fallbackResults_, ray, RAY_TRIANGLE, maxDistance, drawableFlags, viewMask);
+		drawable->ProcessRayQuery(query, fallbackResults_);
+
+		float closest = M_INFINITY;
+		for (unsigned i = 0; i < fallbackResults_.Size(); ++i)
+		{
+			if (fallbackResults_[i].distance_ < closest && fallbackResults_[i].distance_ < maxDistance)
+			{
+				closest = fallbackResults_[i].distance_;
+				result = fallbackResults_[i];
+			}
+		}
+
+		return closest;
+	}
+
+	void EditorPicking::Benchmark(const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, unsigned iterations)
+	{
+		Octree* octree = scene_ ? scene_->GetComponent<Octree>() : NULL;
+		if (!octree || !iterations)
+			return;
+
+		HiresTimer timer;
+		UpdateTree();
+		long long buildTime = timer.GetUSec(true);
+
+		RayQueryResult bvhResult;
+		for (unsigned i = 0; i < iterations; ++i)
+			RaycastSingle(ray, maxDistance, drawableFlags, viewMask, bvhResult);
+		long long bvhTime = timer.GetUSec(true);
+
+		PODVector<RayQueryResult> octreeResults;
+		for (unsigned i = 0; i < iterations; ++i)
+		{
+			RayOctreeQuery query(octreeResults, ray, RAY_TRIANGLE, maxDistance, drawableFlags, viewMask);
+			octree->RaycastSingle(query);
+		}
+		long long octreeTime = timer.GetUSec(true);
+
+		Drawable* octreeHit = octreeResults.Size() ? octreeResults[0].drawable_ : NULL;
+
+		LOGINFOF("Picking benchmark: %u drawables, %u model BVHs, tree update %.3f ms", entries_.Size(), modelBVHs_.Size(),
+			buildTime / 1000.0f);
+		LOGINFOF("Picking benchmark: BVH %.4f ms/pick, octree %.4f ms/pick over %u picks, results %s", bvhTime / 1000.0f / iterations,
+			octreeTime / 1000.0f / iterations, iterations, bvhResult.drawable_ == octreeHit ? "match" : "differ");
+	}
+
+	ModelBVH* EditorPicking::GetModelBVH(Model* model)
+	{
+		if (!model || model->GetName().Empty())
+			return NULL;
+
+		SharedPtr<ModelBVH>& bvh = modelBVHs_[model->GetNameHash()];
+		// Rebuild if the cached model has been released and loaded again
+		if (!bvh || bvh->GetModel() != model)
+			bvh = new ModelBVH(model);
+
+		return bvh->GetNumTriangles() ? bvh.Get() : NULL;
+	}
+
+	void EditorPicking::UpdateTree()
+	{
+		if (structureDirty_)
+			Rebuild();
+		else if (transformsDirty_)
+			Refit();
+	}
+
+	void EditorPicking::Rebuild()
+	{
+		structureDirty_ = false;
+		transformsDirty_ = false;
+		entries_.Clear();
+		nodes_.Clear();
+
+		if (!scene_)
+			return;
+
+		PODVector<Node*> nodes;
+		scene_->GetChildren(nodes, true);
+		nodes.Push(scene_);
+
+		Vector<PickEntry> entries;
+		for (unsigned i = 0; i < nodes.Size(); ++i)
+		{
+			const Vector<SharedPtr<Component> >& components = nodes[i]->GetComponents();
+			for (unsigned j = 0; j < components.Size(); ++j)
+			{
+				Drawable* drawable = dynamic_cast<Drawable*>(components[j].Get());
+				if (!drawable)
+					continue;
+
+				PickEntry entry;
+				entry.drawable_ = drawable;
+				entry.model_ = NULL;
+				entry.box_ = drawable->GetWorldBoundingBox();
+				entries.Push(entry);
+			}
+		}
+
+		if (entries.Empty())
+			return;
+
+		order_.Resize(entries.Size());
+		for (unsigned i = 0; i < order_.Size(); ++i)
+			order_[i] = i;
+
+		// Build over the unsorted entries, then store them in leaf order
+		entries_ = entries;
+		nodes_.Reserve(entries.Size() * 2 / MAX_DRAWABLES_PER_LEAF + 1);
+		BuildNode(0, entries.Size(), 0);
+
+		for (unsigned i = 0; i < order_.Size(); ++i)
+			entries_[i] = entries[order_[i]];
+		order_.Clear();
+	}
+
+	unsigned EditorPicking::BuildNode(unsigned first, unsigned count, unsigned depth)
+	{
+		unsigned nodeIndex = nodes_.Size();
+		nodes_.Resize(nodeIndex + 1);
+
+		BoundingBox box;
+		BoundingBox centroidBox;
+		for (unsigned i = first; i < first + count; ++i)
+		{
+			const BoundingBox& entryBox = entries_[order_[i]].box_;
+			if (!entryBox.Defined())
+				continue;
+			box.Merge(entryBox);
+			centroidBox.Merge(entryBox.Center());
+		}
+		nodes_[nodeIndex].box_ = box;
+
+		if (count <= MAX_DRAWABLES_PER_LEAF)
+		{
+			nodes_[nodeIndex].first_ = first;
+			nodes_[nodeIndex].count_ = count;
+			return nodeIndex;
+		}
+
+		Vector3 size = centroidBox.Size();
+		unsigned axis = 0;
+		if (size.y_ > size.x_)
+			axis = 1;
+		if (size.z_ > size.Data()[axis])
+			axis = 2;
+		float split = centroidBox.Center().Data()[axis];
+
+		unsigned mid = first;
+		unsigned end = first + count;
+		while (mid < end)
+		{
+			if (entries_[order_[mid]].box_.Center().Data()[axis] < split)
+				++mid;
+			else
+			{
+				--end;
+				unsigned temp = order_[mid];
+				order_[mid] = order_[end];
+				order_[end] = temp;
+			}
+		}
+
+		if (mid == first || mid == first + count || depth >= MAX_BVH_DEPTH)
+			mid = first + count / 2;
+
+		BuildNode(first, mid - first, depth + 1);
+		unsigned right = BuildNode(mid, first + count - mid, depth + 1);
+
+		nodes_[nodeIndex].first_ = right;
+		nodes_[nodeIndex].count_ = 0;
+		return nodeIndex;
+	}
+
+	void EditorPicking::Refit()
+	{
+		transformsDirty_ = false;
+
+		for (unsigned i = 0; i < entries_.Size(); ++i)
+		{
+			Drawable* drawable = entries_[i].drawable_;
+			entries_[i].box_ = drawable ? drawable->GetWorldBoundingBox() : BoundingBox();
+		}
+
+		// Children always follow their parent, so walking backwards visits them first
+		for (unsigned i = nodes_.Size() - 1; i < nodes_.Size(); --i)
+		{
+			PickNode& node = nodes_[i];
+			BoundingBox box;
+			if (node.count_)
+			{
+				for (unsigned j = node.first_; j < node.first_ + node.count_; ++j)
+				{
+					if (entries_[j].box_.Defined())
+						box.Merge(entries_[j].box_);
+				}
+			}
+			else
+			{
+				if (nodes_[i + 1].box_.Defined())
+					box.Merge(nodes_[i + 1].box_);
+				if (nodes_[node.first_].box_.Defined())
+					box.Merge(nodes_[node.first_].box_);
+			}
+			node.box_ = box;
+		}
+	}
+
+	void EditorPicking::AddBodyListener(Node* node)
+	{
+		if (node && node != scene_)
+			node->AddListener(bodyListener_);
+	}
+
+	void EditorPicking::HandleSceneStructureChanged(StringHash eventType, VariantMap& eventData)
+	{
+		MarkStructureDirty();
+
+		// New bodies enter the physics world with valid bounds, only their later moves need tracking
+		if (eventType == E_COMPONENTADDED)
+		{
+			using namespace ComponentAdded;
+
+			Component* component = static_cast<Component*>(eventData[P_COMPONENT].GetPtr());
+			if (component && component->GetType() == RigidBody::GetTypeStatic())
+				AddBodyListener(static_cast<Node*>(eventData[P_NODE].GetPtr()));
+		}
+		else if (eventType == E_NODEADDED)
+		{
+			using namespace NodeAdded;
+
+			Node* node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+			PODVector<RigidBody*> bodies;
+			if (node)
+				node->GetComponents<RigidBody>(bodies, true);
+			for (unsigned i = 0; i < bodies.Size(); ++i)
+				AddBodyListener(bodies[i]->GetNode());
+		}
+	}
+
+	void EditorPicking::HandleTransformsChanged(StringHash eventType, VariantMap& eventData)
+	{
+		MarkTransformsDirty();
+		// Simulation steps and attribute edits may change bodies in ways the listener does not see
+		physicsDirty_ = true;
+	}
+
+	void EditorPicking::HandleEnabledChanged(StringHash eventType, VariantMap& eventData)
+	{
+		// The tree still holds the drawable, only the results change
+		++modificationCount_;
+	}
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Scene/Component.h"
+#include "../Container/HashSet.h"
+#include "../Container/HashMap.h"
+#include "../Container/Ptr.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
+#include "../Graphics/OctreeQuery.h"
+
+namespace Urho3D
+{
+	class Scene;
+	class Model;
+	class Drawable;
+	class Octree;
+	class PhysicsWorld;
+	class EditorPicking;
+
+	/// Transform listener registered on nodes with rigid bodies. Reports moved nodes to the picking structure.
+	class PickTransformListener : public Component
+	{
+		OBJECT(PickTransformListener);
+	public:
+		/// Construct.
+		PickTransformListener(Context* context, EditorPicking* picking);
+
+	protected:
+		/// Handle node transform being dirtied.
+		virtual void OnMarkedDirty(Node* node);
+
+		/// Picking structure to notify.
+		WeakPtr<EditorPicking> picking_;
+	};
+
+	/// Triangle bounding volume hierarchy of a Model's LOD 0 geometries, in model space. Shared by all drawables using the model.
+	class ModelBVH : public RefCounted
+	{
+	public:
+		/// Construct and build from the model's raw vertex and index data.
+		ModelBVH(Model* model);
+		/// Destruct.
+		virtual ~ModelBVH();
+
+		/// Return distance to the closest front facing triangle hit by a model space ray, or M_INFINITY.
+		float Raycast(const Ray& ray, float maxDistance, unsigned& outTriangle) const;
+		/// Return the vertices of a triangle.
+		void GetTriangle(unsigned index, Vector3& v0, Vector3& v1, Vector3& v2) const;
+		/// Return geometry index of a triangle.
+		unsigned GetGeometryIndex(unsigned index) const { return geometries_[index]; }
+
+		/// Return the model this BVH was built from, null if it has been released.
+		Model* GetModel() const { return model_; }
+		/// Return number of triangles.
+		unsigned GetNumTriangles() const { return geometries_.Size(); }
+		/// Return number of tree nodes.
+		unsigned GetNumNodes() const { return nodes_.Size(); }
+
+	protected:
+		struct BVHNode
+		{
+			/// Bounds of all triangles below this node.
+			BoundingBox box_;
+			/// Leaf: first triangle. Inner node: index of the right child, the left child follows this node directly.
+			unsigned first_;
+			/// Leaf: number of triangles. Zero for inner nodes.
+			unsigned count_;
+		};
+
+		/// Build a subtree over the triangles in order_[first, first + count) and return its node index.
+		unsigned BuildNode(unsigned first, unsigned count, unsigned depth, const PODVector<Vector3>& centroids);
+
+		/// Source model.
+		WeakPtr<Model> model_;
+		/// Triangle vertices, three per triangle, sorted in leaf order after the build.
+		PODVector<Vector3> vertices_;
+		/// Geometry index per triangle.
+		PODVector<unsigned> geometries_;
+		/// Triangle order used while building.
+		PODVector<unsigned> order_;
+		/// Tree nodes, the root is at index 0.
+		PODVector<BVHNode> nodes_;
+	};
+
+	/// Editor side picking structure: a refittable BVH over the scene drawables, with per-Model triangle BVHs cached by resource.
+	class EditorPicking : public Object
+	{
+		OBJECT(EditorPicking);
+	public:
+		/// Construct.
+		EditorPicking(Context* context, Scene* scene = NULL);
+		/// Destruct.
+		virtual ~EditorPicking();
+
+		/// Set the scene to pick from.
+		void SetScene(Scene* scene);
+		/// Force a full rebuild before the next pick.
+		void MarkStructureDirty() { structureDirty_ = true; ++modificationCount_; }
+		/// Refit the drawable bounds before the next pick.
+		void MarkTransformsDirty() { transformsDirty_ = true; ++modificationCount_; }
+		/// Return a counter that changes whenever the pickable scene content may have changed.
+		unsigned GetModificationCount() const { return modificationCount_; }
+		/// Record a rigid body node whose transform changed.
+		void MarkBodyMoved(Node* node);
+		/// Refresh the broadphase bounds of the rigid bodies moved since the last call, or of all bodies after unknown changes.
+		void UpdatePhysicsBounds(PhysicsWorld* physicsWorld);
+
+		/// Raycast the closest drawable, equivalent to Octree::RaycastSingle with RAY_TRIANGLE. Return true on hit.
+		bool RaycastSingle(const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, RayQueryResult& result);
+		/// Time both this and the octree pick path and log the results.
+		void Benchmark(const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, unsigned iterations = 1000);
+
+		/// Return the triangle BVH of a model, building it on first use.
+		ModelBVH* GetModelBVH(Model* model);
+		/// Return number of drawables in the tree.
+		unsigned GetNumDrawables() const { return entries_.Size(); }
+		/// Return number of cached model BVHs.
+		unsigned GetNumModelBVHs() const { return modelBVHs_.Size(); }
+
+	protected:
+		struct PickEntry
+		{
+			/// Drawable.
+			WeakPtr<Drawable> drawable_;
+			/// Model the BVH was fetched for.
+			Model* model_;
+			/// Triangle BVH, null when the drawable is tested through its own ProcessRayQuery().
+			SharedPtr<ModelBVH> bvh_;
+			/// World bounds at the last refit.
+			BoundingBox box_;
+		};
+
+		struct PickNode
+		{
+			/// Bounds of all entries below this node.
+			BoundingBox box_;
+			/// Leaf: first entry. Inner node: index of the right child, the left child follows this node directly.
+			unsigned first_;
+			/// Leaf: number of entries. Zero for inner nodes.
+			unsigned count_;
+		};
+
+		/// Rebuild or refit the tree if needed.
+		void UpdateTree();
+		/// Collect the scene drawables and build the tree.
+		void Rebuild();
+		/// Update entry bounds from the drawables and propagate them up the tree.
+		void Refit();
+		/// Build a subtree over order_[first, first + count) and return its node index.
+		unsigned BuildNode(unsigned first, unsigned count, unsigned depth);
+		/// Test one entry against the ray. Return hit distance or M_INFINITY.
+		float RaycastEntry(PickEntry& entry, const Ray& ray, float maxDistance, unsigned char drawableFlags, unsigned viewMask, RayQueryResult& result);
+
+		/// Scene events that change the drawable set.
+		void HandleSceneStructureChanged(StringHash eventType, VariantMap& eventData);
+		/// Events that may move drawables.
+		void HandleTransformsChanged(StringHash eventType, VariantMap& eventData);
+		/// Node or component enabled state changed.
+		void HandleEnabledChanged(StringHash eventType, VariantMap& eventData);
+		/// Start listening to the transforms of a rigid body node.
+		void AddBodyListener(Node* node);
+
+		/// Scene.
+		WeakPtr<Scene> scene_;
+		/// Drawables, sorted in leaf order.
+		Vector<PickEntry> entries_;
+		/// Entry order used while building.
+		PODVector<unsigned> order_;
+		/// Tree nodes, the root is at index 0.
+		PODVector<PickNode> nodes_;
+		/// Triangle BVHs by model name hash.
+		HashMap<StringHash, SharedPtr<ModelBVH> > modelBVHs_;
+		/// Scratch results for drawables without a triangle BVH.
+		PODVector<RayQueryResult> fallbackResults_;
+		/// Drawable set changed.
+		bool structureDirty_;
+		/// Drawable bounds changed.
+		bool transformsDirty_;
+		/// Scene modification counter.
+		unsigned modificationCount_;
+		/// Listener registered on the rigid body nodes.
+		SharedPtr<PickTransformListener> bodyListener_;
+		/// IDs of rigid body nodes moved since the last physics refresh.
+		HashSet<unsigned> movedBodyNodes_;
+		/// All rigid body bounds need a refresh.
+		bool physicsDirty_;
+	};
+}
@@ -0,0 +1,142 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "EditorProfiler.h"
+#include "../Core/CoreEvents.h"
+#include "../Container/Sort.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+
+namespace Urho3D
+{
+	/// Frames kept for the rolling statistics and the CSV export.
+	static const unsigned FRAME_HISTORY_SIZE = 600;
+
+	static const String stageNames[] = {
+		"Gizmo",
+		"Hover raycast",
+		"Debug draw",
+		"Hierarchy",
+		"Inspector",
+		"Scene update"
+	};
+
+	EditorProfiler::EditorProfiler(Context* context) : Object(context),
+		firstFrame_(0),
+		numFrames_(0),
+		frameStarted_(false),
+		p50_(0.0f),
+		p95_(0.0f),
+		p99_(0.0f)
+	{
+		frameTimes_.Resize(FRAME_HISTORY_SIZE);
+		stageTimes_.Resize(FRAME_HISTORY_SIZE * MAX_EDITOR_STAGES);
+		for (unsigned i = 0; i < MAX_EDITOR_STAGES; ++i)
+		{
+			currentStageTimes_[i] = 0;
+			stageAverages_[i] = 0.0f;
+		}
+
+		SubscribeToEvent(E_BEGINFRAME, HANDLER(EditorProfiler, HandleBeginFrame));
+		SubscribeToEvent(E_EDITORSTAGETIME, HANDLER(EditorProfiler, HandleStageTime));
+	}
+
+	EditorProfiler::~EditorProfiler()
+	{
+	}
+
+	void EditorProfiler::RegisterObject(Context* context)
+	{
+		context->RegisterFactory<EditorProfiler>();
+	}
+
+	const String& EditorProfiler::GetStageName(EditorStage stage)
+	{
+		return stage < MAX_EDITOR_STAGES ? stageNames[stage] : String::EMPTY;
+	}
+
+	void EditorProfiler::UpdateStatistics()
+	{
+		if (!numFrames_)
+			return;
+
+		sorted_.Resize(numFrames_);
+		for (unsigned i = 0; i < numFrames_; ++i)
+			sorted_[i] = frameTimes_[(firstFrame_ + i) % FRAME_HISTORY_SIZE];
+		Sort(sorted_.Begin(), sorted_.End());
+
+		p50_ = sorted_[(numFrames_ - 1) * 50 / 100];
+		p95_ = sorted_[(numFrames_ - 1) * 95 / 100];
+		p99_ = sorted_[(numFrames_ - 1) * 99 / 100];
+
+		for (unsigned j = 0; j < MAX_EDITOR_STAGES; ++j)
+		{
+			float total = 0.0f;
+			for (unsigned i = 0; i < numFrames_; ++i)
+				total += stageTimes_[((firstFrame_ + i) % FRAME_HISTORY_SIZE) * MAX_EDITOR_STAGES + j];
+			stageAverages_[j] = total / (float)numFrames_;
+		}
+	}
+
+	bool EditorProfiler::ExportCSV(const String& fileName)
+	{
+		File file(context_);
+		if (!file.Open(fileName, FILE_WRITE))
+		{
+			LOGERRORF("Could not open %s for writing frame times", fileName.CString());
+			return false;
+		}
+
+		String line("Frame,Frame ms");
+		for (unsigned j = 0; j < MAX_EDITOR_STAGES; ++j)
+			line += "," + stageNames[j] + " ms";
+		file.WriteLine(line);
+
+		for (unsigned i = 0; i < numFrames_; ++i)
+		{
+			unsigned index = (firstFrame_ + i) % FRAME_HISTORY_SIZE;
+			line = String(i) + "," + String(frameTimes_[index]);
+			for (unsigned j = 0; j < MAX_EDITOR_STAGES; ++j)
+				line += "," + String(stageTimes_[index * MAX_EDITOR_STAGES + j]);
+			file.WriteLine(line);
+		}
+
+		LOGINFOF("Exported %u frame times to %s", numFrames_, fileName.CString());
+		return true;
+	}
+
+	void EditorProfiler::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+	{
+		if (frameStarted_)
+		{
+			unsigned index;
+			if (numFrames_ < FRAME_HISTORY_SIZE)
+				index = (firstFrame_ + numFrames_++) % FRAME_HISTORY_SIZE;
+			else
+			{
+				index = firstFrame_;
+				firstFrame_ = (firstFrame_ + 1) % FRAME_HISTORY_SIZE;
+			}
+
+			frameTimes_[index] = (float)frameTimer_.GetUSec(true) / 1000.0f;
+			for (unsigned j = 0; j < MAX_EDITOR_STAGES; ++j)
+			{
+				stageTimes_[index * MAX_EDITOR_STAGES + j] = (float)currentStageTimes_[j] / 1000.0f;
+				currentStageTimes_[j] = 0;
+			}
+		}
+		else
+		{
+			frameTimer_.Reset();
+			frameStarted_ = true;
+		}
+	}
+
+	void EditorProfiler::HandleStageTime(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace EditorStageTime;
+
+		int stage = eventData[P_STAGE].GetInt();
+		if (stage >= 0 && stage < MAX_EDITOR_STAGES)
+			AddStageTime((EditorStage)stage, eventData[P_TIME].GetUInt());
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+#include "../Container/Vector.h"
+#include "Utils/StageTimer.h"
+
+namespace Urho3D
+{
+	/// Rolling frame time and editor stage timings, collected from E_EDITORSTAGETIME. Registered as a subsystem by the Editor.
+	class EditorProfiler : public Object
+	{
+		OBJECT(EditorProfiler);
+	public:
+		/// Construct.
+		EditorProfiler(Context* context);
+		/// Destruct.
+		virtual ~EditorProfiler();
+		/// Register object factory.
+		static void RegisterObject(Context* context);
+
+		/// Add time spent in a stage during the current frame.
+		void AddStageTime(EditorStage stage, long long usec) { currentStageTimes_[stage] += usec; }
+		/// Recompute the percentiles and stage averages over the recorded frames.
+		void UpdateStatistics();
+		/// Write the recorded frames to a CSV file. Return true on success.
+		bool ExportCSV(const String& fileName);
+
+		/// Return frame time percentile in milliseconds, as of the last UpdateStatistics().
+		float GetFrameTimeP50() const { return p50_; }
+		float GetFrameTimeP95() const { return p95_; }
+		float GetFrameTimeP99() const { return p99_; }
+		/// Return average stage time in milliseconds, as of the last UpdateStatistics().
+		float GetStageAverage(EditorStage stage) const { return stageAverages_[stage]; }
+		/// Return number of recorded frames.
+		unsigned GetNumFrames() const { return numFrames_; }
+		/// Return display name of a stage.
+		static const String& GetStageName(EditorStage stage);
+
+	protected:
+		/// Close the previous frame record.
+		void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+		/// Add a timed stage to the current frame.
+		void HandleStageTime(StringHash eventType, VariantMap& eventData);
+
+		/// Frame times in milliseconds, ring buffer.
+		PODVector<float> frameTimes_;
+		/// Stage times in milliseconds, MAX_EDITOR_STAGES per frame, same ring order as frameTimes_.
+		PODVector<float> stageTimes_;
+		/// Scratch for sorting.
+		PODVector<float> sorted_;
+		/// Ring buffer index of the oldest frame.
+		unsigned firstFrame_;
+		/// Number of recorded frames.
+		unsigned numFrames_;
+		/// Time since the current frame began.
+		HiresTimer frameTimer_;
+		/// Whether a frame is in progress.
+		bool frameStarted_;
+		/// Stage times of the current frame in microseconds.
+		long long currentStageTimes_[MAX_EDITOR_STAGES];
+		/// Frame time percentiles.
+		float p50_;
+		float p95_;
+		float p99_;
+		/// Stage averages in milliseconds.
+		float stageAverages_[MAX_EDITOR_STAGES];
+	};
+}
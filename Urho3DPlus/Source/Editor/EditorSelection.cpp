@@ -13,7 +13,7 @@
 #include "../Input/InputEvents.h"
 #include "../IO/IOEvents.h"
 #include "../UI/LineEdit.h"
-#include "../UI/ListView.h"
+#include "../UI/HierarchyList.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../UI/ScrollBar.h"
@@ -33,18 +33,33 @@
 #include "ResourcePicker.h"
 #include "../Graphics/Camera.h"
 #include "Editor.h"
+#include "../Graphics/Drawable.h"
 
 namespace Urho3D
 {
 
 
+	SelectionTransformListener::SelectionTransformListener(Context* context, EditorSelection* selection) : Component(context),
+		selection_(selection)
+	{
+	}
+
+	void SelectionTransformListener::OnMarkedDirty(Node* node)
+	{
+		if (selection_)
+			selection_->MarkBoundsDirty();
+	}
+
 	EditorSelection::EditorSelection(Context* context, Editor* editor) : Object(context),
 		editUIElement_(NULL),
 		editNode_(NULL),
 		numEditableComponentsPerNode_(1),
-		editor_(editor)
+		editor_(editor),
+		editNodesContainScene_(false),
+		boundsDirty_(true),
+		listenersDirty_(true)
 	{
-
+		transformListener_ = new SelectionTransformListener(context_, this);
 	}
 
 	EditorSelection::~EditorSelection()
@@ -59,6 +74,7 @@ namespace Urho3D
 
 	void EditorSelection::ClearSelection()
 	{
+		MarkSelectionDirty();
 		selectedNodes_.Clear();
 		selectedComponents_.Clear();
 		selectedUIElements_.Clear();
@@ -77,12 +93,14 @@ namespace Urho3D
 
 	void EditorSelection::AddSelectedComponent(Component* comp)
 	{
+		MarkSelectionDirty();
 		if (comp != NULL)
 			selectedComponents_.Push(comp);
 	}
 
 	void EditorSelection::AddSelectedNode(Node* node)
 	{
+		MarkSelectionDirty();
 		if (node != NULL)
 			selectedNodes_.Push(node);
 	}
@@ -95,6 +113,7 @@ namespace Urho3D
 
 	void EditorSelection::AddEditNode(Node* node)
 	{
+		MarkSelectionDirty();
 		if (node != NULL)
 			editNodes_.Push(node);
 	}
@@ -176,11 +195,13 @@ namespace Urho3D
 
 	void EditorSelection::SetSelectedNodes(Vector<Node*>& nodes)
 	{
+		MarkSelectionDirty();
 		selectedNodes_ = nodes;
 	}
 
 	void EditorSelection::SetSelectedComponents(Vector<Component*>& comps)
 	{
+		MarkSelectionDirty();
 		selectedComponents_ = comps;
 	}
 
@@ -191,6 +212,7 @@ namespace Urho3D
 
 	void EditorSelection::SetEditNodes(Vector<Node*>& nodes)
 	{
+		MarkSelectionDirty();
 		editNodes_ = nodes;
 	}
 
@@ -241,15 +263,18 @@ namespace Urho3D
 
 
 
-	void EditorSelection::OnHierarchyListSelectionChange(const PODVector<UIElement*>& items, const PODVector<unsigned>& indices)
+	void EditorSelection::OnHierarchyListSelectionChange(HierarchyList* list)
 	{
+		const PODVector<unsigned>& indices = list->GetSelections();
+
+		// ClearSelection() marks the cached bounds and listeners dirty
 		ClearSelection();
 
 		for (unsigned int i = 0; i < indices.Size(); ++i)
 		{
 			unsigned int index = indices[i];
-			UIElement* item = items[index];
-			int type = item->GetVar(TYPE_VAR).GetInt();
+			const HierarchyListItem& item = list->GetItem(index);
+			int type = item.type_;
 			if (type == ITEM_COMPONENT)
 			{
 				Component* comp = editor_->GetListComponent(item);
@@ -368,4 +393,112 @@ namespace Urho3D
 
 	}
 
-}
\ No newline at end of file
+	const Vector3& EditorSelection::GetSelectionCenter()
+	{
+		if (boundsDirty_)
+			UpdateBounds();
+		return selectionCenter_;
+	}
+
+	const BoundingBox& EditorSelection::GetSelectionBox()
+	{
+		if (boundsDirty_)
+			UpdateBounds();
+		return selectionBox_;
+	}
+
+	const Vector3& EditorSelection::GetEditNodesPivot()
+	{
+		if (boundsDirty_)
+			UpdateBounds();
+		return editNodesPivot_;
+	}
+
+	bool EditorSelection::GetEditNodesContainScene()
+	{
+		if (boundsDirty_)
+			UpdateBounds();
+		return editNodesContainScene_;
+	}
+
+	void EditorSelection::UpdateBounds()
+	{
+		if (listenersDirty_)
+		{
+			for (unsigned int i = 0; i < listenedNodes_.Size(); ++i)
+			{
+				if (listenedNodes_[i])
+					listenedNodes_[i]->RemoveListener(transformListener_);
+			}
+			listenedNodes_.Clear();
+
+			for (unsigned int i = 0; i < selectedNodes_.Size(); ++i)
+				AddTransformListener(selectedNodes_[i]);
+			for (unsigned int i = 0; i < selectedComponents_.Size(); ++i)
+				AddTransformListener(selectedComponents_[i]->GetNode());
+			for (unsigned int i = 0; i < editNodes_.Size(); ++i)
+				AddTransformListener(editNodes_[i]);
+
+			listenersDirty_ = false;
+		}
+
+		selectionCenter_ = Vector3::ZERO;
+		selectionBox_.Clear();
+		for (unsigned int i = 0; i < selectedNodes_.Size(); ++i)
+		{
+			Node* node = selectedNodes_[i];
+			Vector3 position = node->GetWorldPosition();
+			selectionCenter_ += position;
+			selectionBox_.Merge(position);
+			for (unsigned int j = 0; j < node->GetNumComponents(); ++j)
+			{
+				Drawable* drawable = dynamic_cast<Drawable*>(node->GetComponents()[j].Get());
+				if (drawable != NULL)
+					selectionBox_.Merge(drawable->GetWorldBoundingBox());
+			}
+		}
+
+		for (unsigned int i = 0; i < selectedComponents_.Size(); ++i)
+		{
+			Drawable* drawable = dynamic_cast<Drawable*>(selectedComponents_[i]);
+			if (drawable != NULL)
+			{
+				selectionCenter_ += drawable->GetNode()->LocalToWorld(drawable->GetBoundingBox().Center());
+				selectionBox_.Merge(drawable->GetWorldBoundingBox());
+			}
+			else
+			{
+				Vector3 position = selectedComponents_[i]->GetNode()->GetWorldPosition();
+				selectionCenter_ += position;
+				selectionBox_.Merge(position);
+			}
+		}
+
+		unsigned int count = selectedNodes_.Size() + selectedComponents_.Size();
+		if (count > 0)
+			selectionCenter_ /= (float)count;
+
+		editNodesPivot_ = Vector3::ZERO;
+		editNodesContainScene_ = false;
+		for (unsigned int i = 0; i < editNodes_.Size(); ++i)
+		{
+			if (editNodes_[i] == editNodes_[i]->GetScene())
+				editNodesContainScene_ = true;
+			editNodesPivot_ += editNodes_[i]->GetWorldPosition();
+		}
+		if (!editNodes_.Empty())
+			editNodesPivot_ /= (float)editNodes_.Size();
+
+		boundsDirty_ = false;
+	}
+
+	void EditorSelection::AddTransformListener(Node* node)
+	{
+		// The scene is never moved by the editor
+		if (node == NULL || node == node->GetScene())
+			return;
+
+		node->AddListener(transformListener_);
+		listenedNodes_.Push(WeakPtr<Node>(node));
+	}
+}
@@ -1,8 +1,10 @@
 #pragma once
 #include "../Core/Object.h"
+#include "../Scene/Component.h"
 
 #include "..\Container\Vector.h"
 #include "..\Core\Variant.h"
+#include "..\Math\BoundingBox.h"
 #include "Utils/Macros.h"
 
 namespace Urho3D
@@ -17,6 +19,7 @@ namespace Urho3D
 	class Graphics;
 	class ProjectWindow;
 	class HierarchyWindow;
+	class HierarchyList;
 	class Scene;
 	class View3D;
 	class Window;
@@ -29,7 +32,23 @@ namespace Urho3D
 	class AttributeInspector;
 	class FileSelector;
 	class Camera;
+	class EditorSelection;
 
+	/// Transform listener registered on the selected nodes. Invalidates the cached selection bounds.
+	class SelectionTransformListener : public Component
+	{
+		OBJECT(SelectionTransformListener);
+	public:
+		/// Construct.
+		SelectionTransformListener(Context* context, EditorSelection* selection);
+
+	protected:
+		/// Handle node transform being dirtied.
+		virtual void OnMarkedDirty(Node* node);
+
+		/// Selection to notify.
+		WeakPtr<EditorSelection> selection_;
+	};
 
 	class EditorSelection : public Object
 	{
@@ -78,8 +97,26 @@ namespace Urho3D
 		void			SetGlobalVarNames(const String& name);
 		const Variant&	GetGlobalVarNames(StringHash& name);
 
-		void OnHierarchyListSelectionChange(const PODVector<UIElement*>& items, const PODVector<unsigned>& indices);
+		void OnHierarchyListSelectionChange(HierarchyList* list);
+
+		/// Return the average world position of the selected nodes and components.
+		const Vector3& GetSelectionCenter();
+		/// Return the world bounds of the selected nodes and components.
+		const BoundingBox& GetSelectionBox();
+		/// Return the average world position of the edit nodes, used as gizmo pivot.
+		const Vector3& GetEditNodesPivot();
+		/// Return whether the scene is one of the edit nodes.
+		bool GetEditNodesContainScene();
+		/// Invalidate the cached center, bounds and pivot. Done automatically on selection changes and selected node moves.
+		void MarkBoundsDirty() { boundsDirty_ = true; }
+		/// Invalidate the cached data and the transform listeners after changing the selection through the returned vectors.
+		void MarkSelectionDirty() { boundsDirty_ = true; listenersDirty_ = true; }
 	protected:
+		/// Recompute the cached center, bounds and pivot, and move the transform listener to the current selection.
+		void UpdateBounds();
+		/// Listen to the transform of a node.
+		void AddTransformListener(Node* node);
+
 		/// Selection
 		Vector<Node*>		selectedNodes_;
 		Vector<Component*>	selectedComponents_;
@@ -97,6 +134,20 @@ namespace Urho3D
 		// Node or UIElement hash-to-varname reverse mapping
 		VariantMap globalVarNames_;
 
+		/// Cached selection center, bounds and edit node pivot.
+		Vector3		selectionCenter_;
+		BoundingBox	selectionBox_;
+		Vector3		editNodesPivot_;
+		bool		editNodesContainScene_;
+		/// Cached data needs to be recomputed.
+		bool		boundsDirty_;
+		/// Selection changed since the transform listener was registered.
+		bool		listenersDirty_;
+		/// Listener registered on the selected nodes.
+		SharedPtr<SelectionTransformListener> transformListener_;
+		/// Nodes the listener is registered on.
+		Vector<WeakPtr<Node> > listenedNodes_;
+
 		
 
 	};
@@ -18,6 +18,8 @@
 #include "../Input/Input.h"
 #include "../Graphics/Viewport.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/DebugRenderer.h"
+#include "../Graphics/Drawable.h"
 
 namespace Urho3D
 {
@@ -31,6 +33,10 @@ namespace Urho3D
 		gizmoAxisY = new GizmoAxis(context);
 		gizmoAxisZ = new GizmoAxis(context);
 		epScene3D_ = epScene3D;
+		changed_ = false;
+		previewActive_ = false;
+		previewMode_ = EDIT_MOVE;
+		previewRotation_ = Quaternion::IDENTITY;
 
 		editorData_ = GetSubsystem<EditorData>();
 		editorSelection_ = GetSubsystem<EditorSelection>();
@@ -81,9 +87,24 @@ namespace Urho3D
 
 	void GizmoScene3D::UpdateGizmo()
 	{
+		if (gizmo == NULL)
+		{
+			changed_ = false;
+			return;
+		}
+
+		Matrix3x4 lastTransform = gizmoNode->GetWorldTransform();
+		bool lastEnabled = gizmo->IsEnabled();
+		bool lastSelectedX = gizmoAxisX->lastSelected;
+		bool lastSelectedY = gizmoAxisY->lastSelected;
+		bool lastSelectedZ = gizmoAxisZ->lastSelected;
+
 		UseGizmo();
 		PositionGizmo();
 		ResizeGizmo();
+
+		changed_ = gizmoNode->GetWorldTransform() != lastTransform || gizmo->IsEnabled() != lastEnabled ||
+			gizmoAxisX->lastSelected != lastSelectedX || gizmoAxisY->lastSelected != lastSelectedY || gizmoAxisZ->lastSelected != lastSelectedZ;
 	}
 
 	void GizmoScene3D::PositionGizmo()
@@ -91,27 +112,16 @@ namespace Urho3D
 		if (gizmo == NULL)
 			return;
 		ResourceCache* cache = GetSubsystem<ResourceCache>();
-		Vector3 center(0.0f, 0.0f, 0.0f);
-		bool containsScene = false;
-
-		for (unsigned int i = 0; i < editorSelection_->GetNumEditNodes(); ++i)
-		{
-			// Scene's transform should not be edited, so hide gizmo if it is included
-			if (editorSelection_->GetEditNodes()[i] == editorData_->GetEditorScene())
-			{
-				containsScene = true;
-				break;
-			}
-			center += editorSelection_->GetEditNodes()[i]->GetWorldPosition();
-		}
-
-		if (editorSelection_->GetEditNodes().Empty() || containsScene)
+		// Scene's transform should not be edited, so hide gizmo if it is included
+		if (editorSelection_->GetEditNodes().Empty() || editorSelection_->GetEditNodesContainScene())
 		{
 			HideGizmo();
 			return;
 		}
 
-		center /= (float)editorSelection_->GetNumEditNodes();
+		Vector3 center = editorSelection_->GetEditNodesPivot();
+		if (previewActive_)
+			center = GetPreviewTransform() * previewCenter_;
 		gizmoNode->SetPosition(center);
 
 		if (epScene3D_->axisMode == AXIS_WORLD || editorSelection_->GetNumEditNodes() > 1)
@@ -177,6 +187,13 @@ namespace Urho3D
 
 	void GizmoScene3D::UseGizmo()
 	{
+		Input* input = GetSubsystem<Input>();
+
+		// Commit a previewed drag on release, also when the mouse left the view or the gizmo went away
+		if (previewActive_ && (!input->GetMouseButtonDown(MOUSEB_LEFT) || gizmo == NULL || !gizmo->IsEnabled() ||
+			epScene3D_->editMode != previewMode_))
+			CommitPreview();
+
 		if (gizmo == NULL || !gizmo->IsEnabled() || epScene3D_->editMode == EDIT_SELECT)
 		{
 			// 			StoreGizmoEditActions();
@@ -198,7 +215,6 @@ namespace Urho3D
 		Ray cameraRay = epScene3D_->camera_->GetScreenRay(posx, posy);
 		float scale = gizmoNode->GetScale().x_;
 
-		Input* input = GetSubsystem<Input>();
 		// Recalculate axes only when not left-dragging
 		bool drag = input->GetMouseButtonDown(MOUSEB_LEFT);
 		if (!drag)
@@ -236,6 +252,11 @@ namespace Urho3D
 
 			bool moved = false;
 
+			// Large selections are only previewed while dragging
+			if (!previewActive_ && epScene3D_->gizmoPreview && editorSelection_->GetNumEditNodes() >= epScene3D_->gizmoPreviewMinNodes &&
+				IsGizmoSelected())
+				BeginPreview();
+
 			if (epScene3D_->editMode == EDIT_MOVE)
 			{
 				Vector3 adjust(0, 0, 0);
@@ -246,7 +267,13 @@ namespace Urho3D
 				if (gizmoAxisZ->selected)
 					adjust += Vector3(0, 0, 1) * (gizmoAxisZ->t - gizmoAxisZ->lastT);
 
-				moved = epScene3D_->MoveNodes(adjust);
+				if (previewActive_)
+				{
+					previewMove_ += adjust;
+					moved = adjust != Vector3::ZERO;
+				}
+				else
+					moved = epScene3D_->MoveNodes(adjust);
 			}
 			else if (epScene3D_->editMode == EDIT_ROTATE)
 			{
@@ -258,7 +285,13 @@ namespace Urho3D
 				if (gizmoAxisZ->selected)
 					adjust.z_ = (gizmoAxisZ->d - gizmoAxisZ->lastD) * rotSensitivity / scale;
 
-				moved = epScene3D_->RotateNodes(adjust);
+				if (previewActive_)
+				{
+					previewRotation_ = Quaternion(adjust.x_, adjust.y_, adjust.z_) * previewRotation_;
+					moved = adjust != Vector3::ZERO;
+				}
+				else
+					moved = epScene3D_->RotateNodes(adjust);
 			}
 			else if (epScene3D_->editMode == EDIT_SCALE)
 			{
@@ -277,7 +310,13 @@ namespace Urho3D
 					adjust = Vector3(x, x, x);
 				}
 
-				moved = epScene3D_->ScaleNodes(adjust);
+				if (previewActive_)
+				{
+					previewScale_ += adjust;
+					moved = adjust != Vector3::ZERO;
+				}
+				else
+					moved = epScene3D_->ScaleNodes(adjust);
 			}
 
 			if (moved)
@@ -296,6 +335,75 @@ namespace Urho3D
 		/*		previousGizmoDrag = drag;*/
 	}
 
+	void GizmoScene3D::BeginPreview()
+	{
+		previewActive_ = true;
+		previewMode_ = epScene3D_->editMode;
+		previewMove_ = Vector3::ZERO;
+		previewRotation_ = Quaternion::IDENTITY;
+		previewScale_ = Vector3::ZERO;
+		previewCenter_ = gizmoNode->GetPosition();
+
+		previewBox_.Clear();
+		PODVector<Drawable*> drawables;
+		for (unsigned int i = 0; i < editorSelection_->GetNumEditNodes(); ++i)
+		{
+			Node* node = editorSelection_->GetEditNodes()[i];
+			node->GetComponents<Drawable>(drawables, true);
+			for (unsigned int j = 0; j < drawables.Size(); ++j)
+				previewBox_.Merge(drawables[j]->GetWorldBoundingBox());
+			previewBox_.Merge(node->GetWorldPosition());
+		}
+	}
+
+	void GizmoScene3D::CommitPreview()
+	{
+		previewActive_ = false;
+
+		// One batched transform of the real nodes
+		bool moved = false;
+		if (previewMode_ == EDIT_MOVE)
+			moved = epScene3D_->MoveNodes(previewMove_);
+		else if (previewMode_ == EDIT_ROTATE)
+			moved = epScene3D_->RotateNodes(previewRotation_.EulerAngles());
+		else if (previewMode_ == EDIT_SCALE)
+			moved = epScene3D_->ScaleNodes(previewScale_);
+
+		if (moved)
+			GizmoMoved();
+	}
+
+	Matrix3x4 GizmoScene3D::GetPreviewTransform() const
+	{
+		switch (previewMode_)
+		{
+		case EDIT_MOVE:
+			return Matrix3x4(previewMove_, Quaternion::IDENTITY, Vector3::ONE);
+
+		case EDIT_ROTATE:
+			// RotateNodes rotates around the world origin
+			return Matrix3x4(Vector3::ZERO, previewRotation_, Vector3::ONE);
+
+		case EDIT_SCALE:
+			// Node scales grow additively, approximate that by scaling the box around the gizmo
+			return Matrix3x4(previewCenter_, Quaternion::IDENTITY, Vector3::ONE) *
+				Matrix3x4(Vector3::ZERO, Quaternion::IDENTITY, Vector3::ONE + previewScale_) *
+				Matrix3x4(-previewCenter_, Quaternion::IDENTITY, Vector3::ONE);
+
+		default:
+			return Matrix3x4::IDENTITY;
+		}
+	}
+
+	void GizmoScene3D::DrawPreview(DebugRenderer* debug)
+	{
+		if (previewActive_ && previewBox_.Defined())
+		{
+			debug->AddBoundingBox(previewBox_, GetPreviewTransform(), Color::WHITE, false);
+			debug->AddCross(GetPreviewTransform() * previewCenter_, gizmoNode->GetScale().x_, Color::WHITE, false);
+		}
+	}
+
 	bool GizmoScene3D::IsGizmoSelected()
 	{
 		return gizmo != NULL && gizmo->IsEnabled() && (gizmoAxisX->selected || gizmoAxisY->selected || gizmoAxisZ->selected);
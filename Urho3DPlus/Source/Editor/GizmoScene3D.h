@@ -6,6 +6,7 @@
 #include "../Core/Object.h"
 #include "EPScene3D.h"
 #include "../Math/Ray.h"
+#include "../Math/BoundingBox.h"
 
 
 
@@ -18,6 +19,7 @@ namespace Urho3D
 	class EditorData;
 	class EditorSelection;
 	class EPScene3D;
+	class DebugRenderer;
 
 	class GizmoAxis : public Object
 	{
@@ -64,7 +66,20 @@ namespace Urho3D
 		void GizmoMoved();
 		void UseGizmo();
 		bool IsGizmoSelected();
+		/// Return whether the gizmo appearance changed in the last update.
+		bool IsChanged() const { return changed_; }
+		/// Return whether a drag is being previewed.
+		bool IsPreviewActive() const { return previewActive_; }
+		/// Draw the preview box of the dragged selection.
+		void DrawPreview(DebugRenderer* debug);
 	protected:
+		/// Start previewing a drag of the edit nodes.
+		void BeginPreview();
+		/// Apply the accumulated preview adjustment to the edit nodes.
+		void CommitPreview();
+		/// Return the world transform from the drag start to the previewed state.
+		Matrix3x4 GetPreviewTransform() const;
+
 		EditorData*			editorData_;
 		EditorSelection*	editorSelection_;
 
@@ -76,6 +91,18 @@ namespace Urho3D
 		SharedPtr<GizmoAxis> gizmoAxisY;
 		SharedPtr<GizmoAxis> gizmoAxisZ;
 		EPScene3D* epScene3D_;
+		/// Gizmo moved, was shown or hidden, or changed its highlighted axes in the last update.
+		bool changed_;
+		/// Drag preview: the edit nodes stay in place and are drawn as a box until the mouse is released.
+		bool previewActive_;
+		EditMode previewMode_;
+		/// World bounds and gizmo position of the edit nodes at the drag start.
+		BoundingBox previewBox_;
+		Vector3 previewCenter_;
+		/// Accumulated adjustments.
+		Vector3 previewMove_;
+		Quaternion previewRotation_;
+		Vector3 previewScale_;
 		// For undo
 // 		bool previousGizmoDrag;
 // 		bool needGizmoUndo;
@@ -12,6 +12,7 @@
 #include "../IO/IOEvents.h"
 #include "../UI/LineEdit.h"
 #include "../UI/ListView.h"
+#include "../UI/HierarchyList.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../UI/ScrollBar.h"
@@ -29,6 +30,7 @@
 #include "ToolBarUI.h"
 #include "MiniToolBarUI.h"
 #include "HierarchyWindow.h"
+#include "HierarchyList.h"
 #include "AttributeInspector.h"
 #include "ResourcePicker.h"
 #include "EditorSelection.h"
@@ -347,8 +349,7 @@ namespace Urho3D
 
 	void InGameEditor::HandleHierarchyListSelectionChange(StringHash eventType, VariantMap& eventData)
 	{
-		ListView* hierarchyList = hierarchyWindow_->GetHierarchyList();
-		const PODVector<UIElement*>& items = hierarchyList->GetItems();
+		HierarchyList* hierarchyList = hierarchyWindow_->GetHierarchyList();
 		const PODVector<unsigned>& indices = hierarchyList->GetSelections();
 
 		editorData_->ClearSelection();
@@ -356,8 +357,8 @@ namespace Urho3D
 		for (unsigned int i = 0; i < indices.Size(); ++i)
 		{
 			unsigned int index = indices[i];
-			UIElement* item = items[index];
-			int type = item->GetVar(TYPE_VAR).GetInt();
+			const HierarchyListItem& item = hierarchyList->GetItem(index);
+			int type = item.type_;
 			if (type == ITEM_COMPONENT)
 			{
 				Component* comp = GetListComponent(item);
@@ -476,44 +477,38 @@ namespace Urho3D
 		// 		UpdateCameraPreview();
 	}
 
-	Component* InGameEditor::GetListComponent(UIElement* item)
+	Component* InGameEditor::GetListComponent(const HierarchyListItem& item)
 	{
 		if (scene_.Null())
 			return NULL;
 
-		if (item == NULL)
+		if (item.type_ != ITEM_COMPONENT)
 			return NULL;
 
-		if (item->GetVar(TYPE_VAR).GetInt() != ITEM_COMPONENT)
-			return NULL;
-
-		return scene_->GetComponent(item->GetVar(COMPONENT_ID_VAR).GetUInt());
+		return scene_->GetComponent(item.id_);
 	}
 
-	Node* InGameEditor::GetListNode(UIElement* item)
+	Node* InGameEditor::GetListNode(const HierarchyListItem& item)
 	{
 		if (scene_.Null())
 			return NULL;
 
-		if (item == NULL)
-			return NULL;
-
-		if (item->GetVar(TYPE_VAR).GetInt() != ITEM_NODE)
+		if (item.type_ != ITEM_NODE)
 			return NULL;
 
-		return scene_->GetNode(item->GetVar(NODE_ID_VAR).GetUInt());
+		return scene_->GetNode(item.id_);
 	}
 
-	UIElement* InGameEditor::GetListUIElement(UIElement* item)
+	UIElement* InGameEditor::GetListUIElement(const HierarchyListItem& item)
 	{
 		if (sceneUI_.Null())
 			return NULL;
 
-		if (item == NULL)
+		if (item.type_ != ITEM_UI_ELEMENT)
 			return NULL;
 
-		// Get the text item's ID and use it to retrieve the actual UIElement the text item is associated to
-		return GetUIElementByID(UIUtils::GetUIElementID(item));
+		// Use the item's ID to retrieve the actual UIElement the item is associated to
+		return GetUIElementByID(Variant(item.id_));
 	}
 
 	UIElement* InGameEditor::GetUIElementByID(const Variant& id)
@@ -565,6 +560,7 @@ namespace Urho3D
 		MenuBarUI::RegisterObject(context);
 		ToolBarUI::RegisterObject(context);
 		MiniToolBarUI::RegisterObject(context);
+		HierarchyList::RegisterObject(context);
 
 		PluginScene3DEditor::RegisterObject(context);
 	}
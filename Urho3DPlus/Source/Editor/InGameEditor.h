@@ -28,6 +28,7 @@ namespace Urho3D
 	class Font;
 	class LineEdit;
 	class ListView;
+	struct HierarchyListItem;
 	class Text;
 	class UIElement;
 	class XMLFile;
@@ -100,9 +101,9 @@ namespace Urho3D
 		void HandleMenuBarAction(StringHash eventType, VariantMap& eventData);
 		void HandleHierarchyListSelectionChange(StringHash eventType, VariantMap& eventData);
 
-		Component*	GetListComponent(UIElement* item);
-		Node*		GetListNode(UIElement* item);
-		UIElement*	GetListUIElement(UIElement*  item);
+		Component*	GetListComponent(const HierarchyListItem& item);
+		Node*		GetListNode(const HierarchyListItem& item);
+		UIElement*	GetListUIElement(const HierarchyListItem& item);
 		UIElement*	GetUIElementByID(const Variant& id);
 
 		ResourceCache*	cache_;
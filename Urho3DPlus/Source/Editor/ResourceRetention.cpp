@@ -0,0 +1,211 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "ResourceRetention.h"
+#include "../Container/Sort.h"
+#include "../IO/Log.h"
+#include "../Resource/Resource.h"
+#include "../Resource/ResourceCache.h"
+
+namespace Urho3D
+{
+	static const unsigned long long MB = 1024 * 1024;
+
+	/// Budgets of the resource types scenes use most.
+	static const struct
+	{
+		const char* type_;
+		unsigned long long budget_;
+	} defaultBudgets[] = {
+		{ "Texture2D", 512 * MB },
+		{ "TextureCube", 128 * MB },
+		{ "Texture3D", 64 * MB },
+		{ "Model", 256 * MB },
+		{ "Animation", 64 * MB },
+		{ "Material", 16 * MB },
+		{ "Technique", 4 * MB },
+		{ "Shader", 16 * MB },
+		{ "Sound", 64 * MB },
+		{ "XMLFile", 16 * MB }
+	};
+
+	static const unsigned long long DEFAULT_RETENTION_BUDGET = 32 * MB;
+
+	/// Resource types holding references to other resources, trimmed first so the resources they release can be trimmed after them.
+	static const char* dependentTypes[] = {
+		"ParticleEffect",
+		"Material"
+	};
+
+	/// Least recently used first.
+	static bool CompareUseTimers(Resource* lhs, Resource* rhs)
+	{
+		return lhs->GetUseTimer() > rhs->GetUseTimer();
+	}
+
+	ResourceRetention::ResourceRetention(Context* context) : Object(context),
+		defaultBudget_(DEFAULT_RETENTION_BUDGET),
+		numHits_(0),
+		numMisses_(0),
+		switchTime_(0.0f)
+	{
+		for (unsigned i = 0; i < sizeof(defaultBudgets) / sizeof(defaultBudgets[0]); ++i)
+			SetBudget(defaultBudgets[i].type_, defaultBudgets[i].budget_);
+	}
+
+	ResourceRetention::~ResourceRetention()
+	{
+	}
+
+	void ResourceRetention::RegisterObject(Context* context)
+	{
+		context->RegisterFactory<ResourceRetention>();
+	}
+
+	void ResourceRetention::SetBudget(StringHash type, unsigned long long budget)
+	{
+		budgets_[type] = budget;
+		// The cache applies the budget itself whenever it loads a resource of the type
+		GetSubsystem<ResourceCache>()->SetMemoryBudget(type, budget);
+	}
+
+	unsigned long long ResourceRetention::GetBudget(StringHash type) const
+	{
+		HashMap<StringHash, unsigned long long>::ConstIterator i = budgets_.Find(type);
+		return i != budgets_.End() ? i->second_ : defaultBudget_;
+	}
+
+	void ResourceRetention::SnapshotEditorResources()
+	{
+		editorResources_.Clear();
+
+		const HashMap<StringHash, ResourceGroup>& groups = GetSubsystem<ResourceCache>()->GetAllResources();
+		for (HashMap<StringHash, ResourceGroup>::ConstIterator i = groups.Begin(); i != groups.End(); ++i)
+		{
+			const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
+			for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
+			{
+				if (j->second_->Refs() > 1)
+					editorResources_.Insert(j->first_);
+			}
+		}
+	}
+
+	void ResourceRetention::BeginSceneSwitch()
+	{
+		switchTimer_.Reset();
+		cachedResources_.Clear();
+
+		const HashMap<StringHash, ResourceGroup>& groups = GetSubsystem<ResourceCache>()->GetAllResources();
+		for (HashMap<StringHash, ResourceGroup>::ConstIterator i = groups.Begin(); i != groups.End(); ++i)
+		{
+			HashSet<StringHash>& names = cachedResources_[i->first_];
+			const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
+			for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
+				names.Insert(j->first_);
+		}
+	}
+
+	void ResourceRetention::EndSceneSwitch()
+	{
+		numHits_ = 0;
+		numMisses_ = 0;
+		unsigned long long missBytes = 0;
+
+		const HashMap<StringHash, ResourceGroup>& groups = GetSubsystem<ResourceCache>()->GetAllResources();
+		for (HashMap<StringHash, ResourceGroup>::ConstIterator i = groups.Begin(); i != groups.End(); ++i)
+		{
+			HashMap<StringHash, HashSet<StringHash> >::ConstIterator cached = cachedResources_.Find(i->first_);
+			const HashMap<StringHash, SharedPtr<Resource> >& resources = i->second_.resources_;
+			for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator j = resources.Begin(); j != resources.End(); ++j)
+			{
+				if (j->second_->Refs() <= 1 || editorResources_.Contains(j->first_))
+					continue;
+
+				if (cached != cachedResources_.End() && cached->second_.Contains(j->first_))
+					++numHits_;
+				else
+				{
+					++numMisses_;
+					missBytes += j->second_->GetMemoryUse();
+				}
+			}
+		}
+
+		unsigned long long released = Trim();
+		switchTime_ = (float)switchTimer_.GetUSec(false) / 1000.0f;
+		cachedResources_.Clear();
+
+		unsigned total = numHits_ + numMisses_;
+		LOGINFOF("Scene switch in %.1f ms: %u of %u resources cached (%.0f%%), %u KB loaded, %u KB evicted", switchTime_, numHits_, total,
+			total ? 100.0f * (float)numHits_ / (float)total : 0.0f, (unsigned)(missBytes / 1024), (unsigned)(released / 1024));
+	}
+
+	unsigned long long ResourceRetention::Trim()
+	{
+		ResourceCache* cache = GetSubsystem<ResourceCache>();
+		const HashMap<StringHash, ResourceGroup>& groups = cache->GetAllResources();
+
+		trimOrder_.Clear();
+		for (unsigned i = 0; i < sizeof(dependentTypes) / sizeof(dependentTypes[0]); ++i)
+		{
+			if (groups.Contains(dependentTypes[i]))
+				trimOrder_.Push(dependentTypes[i]);
+		}
+		for (HashMap<StringHash, ResourceGroup>::ConstIterator i = groups.Begin(); i != groups.End(); ++i)
+		{
+			if (!trimOrder_.Contains(i->first_))
+				trimOrder_.Push(i->first_);
+		}
+
+		// A released material can leave its textures and techniques unused, so repeat until a pass releases nothing
+		unsigned long long released = 0;
+		unsigned long long passReleased;
+		do
+		{
+			passReleased = 0;
+			for (unsigned i = 0; i < trimOrder_.Size(); ++i)
+				passReleased += TrimType(trimOrder_[i]);
+			released += passReleased;
+		} while (passReleased);
+
+		return released;
+	}
+
+	unsigned long long ResourceRetention::TrimType(StringHash type)
+	{
+		ResourceCache* cache = GetSubsystem<ResourceCache>();
+		const HashMap<StringHash, ResourceGroup>& groups = cache->GetAllResources();
+		HashMap<StringHash, ResourceGroup>::ConstIterator group = groups.Find(type);
+		if (group == groups.End())
+			return 0;
+
+		unsigned long long budget = GetBudget(type);
+		unsigned long long memoryUse = group->second_.memoryUse_;
+		if (memoryUse <= budget)
+			return 0;
+
+		unused_.Clear();
+		const HashMap<StringHash, SharedPtr<Resource> >& resources = group->second_.resources_;
+		for (HashMap<StringHash, SharedPtr<Resource> >::ConstIterator i = resources.Begin(); i != resources.End(); ++i)
+		{
+			if (i->second_->Refs() == 1)
+				unused_.Push(i->second_);
+		}
+		Sort(unused_.Begin(), unused_.End(), CompareUseTimers);
+
+		// Released after the loop, releasing erases from the map being iterated
+		unsigned long long released = 0;
+		releaseNames_.Clear();
+		for (unsigned i = 0; i < unused_.Size() && memoryUse > budget; ++i)
+		{
+			memoryUse -= unused_[i]->GetMemoryUse();
+			released += unused_[i]->GetMemoryUse();
+			releaseNames_.Push(unused_[i]->GetName());
+		}
+		unused_.Clear();
+		for (unsigned i = 0; i < releaseNames_.Size(); ++i)
+			cache->ReleaseResource(type, releaseNames_[i]);
+
+		return released;
+	}
+}
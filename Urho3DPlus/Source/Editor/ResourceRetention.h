@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+
+namespace Urho3D
+{
+	class Resource;
+
+	/// Keeps unused resources cached up to a memory budget per resource type, so scenes sharing assets switch without reloading them. Registered as a subsystem by the Editor.
+	class ResourceRetention : public Object
+	{
+		OBJECT(ResourceRetention);
+	public:
+		/// Construct with the default budgets.
+		ResourceRetention(Context* context);
+		/// Destruct.
+		virtual ~ResourceRetention();
+		/// Register object factory.
+		static void RegisterObject(Context* context);
+
+		/// Set memory budget in bytes of a resource type. Unused resources are evicted least recently used first when the type is above it.
+		void SetBudget(StringHash type, unsigned long long budget);
+		/// Set memory budget of the types without their own.
+		void SetDefaultBudget(unsigned long long budget) { defaultBudget_ = budget; }
+		/// Return memory budget of a resource type.
+		unsigned long long GetBudget(StringHash type) const;
+
+		/// Record the resources the editor itself holds, they are left out of the switch statistics. Call once at startup, before any scene is loaded.
+		void SnapshotEditorResources();
+		/// Record the cached resources. Call with the old scene already cleared.
+		void BeginSceneSwitch();
+		/// Count the cache hits of the new scene, evict above budget and log the switch.
+		void EndSceneSwitch();
+		/// Evict unused resources of the types above budget, resources holding others first. Return bytes released.
+		unsigned long long Trim();
+
+		/// Return cache hits and misses of the last scene switch.
+		unsigned GetNumHits() const { return numHits_; }
+		unsigned GetNumMisses() const { return numMisses_; }
+		/// Return duration of the last scene switch in milliseconds.
+		float GetSwitchTime() const { return switchTime_; }
+
+	protected:
+		/// Evict unused resources of a type above budget. Return bytes released.
+		unsigned long long TrimType(StringHash type);
+
+		/// Budgets by resource type.
+		HashMap<StringHash, unsigned long long> budgets_;
+		unsigned long long defaultBudget_;
+		/// Name hashes of the resources cached when the switch began, by type.
+		HashMap<StringHash, HashSet<StringHash> > cachedResources_;
+		/// Resources in use at startup, held by the editor rather than the scene.
+		HashSet<StringHash> editorResources_;
+		/// Resource types by trim order.
+		Vector<StringHash> trimOrder_;
+		/// Reused trim buffers.
+		PODVector<Resource*> unused_;
+		Vector<String> releaseNames_;
+		/// Scene switch duration.
+		HiresTimer switchTimer_;
+		/// Last scene switch statistics.
+		unsigned numHits_;
+		unsigned numMisses_;
+		float switchTime_;
+	};
+}
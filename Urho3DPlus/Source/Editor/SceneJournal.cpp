@@ -0,0 +1,561 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "SceneJournal.h"
+#include "SceneSaver.h"
+#include "EditorSelection.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Timer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+#include "../Scene/Component.h"
+#include "AttributeVariableEvents.h"
+
+namespace Urho3D
+{
+	/// Milliseconds the writer thread sleeps when there is nothing to write.
+	static const unsigned JOURNAL_WRITER_SLEEP = 10;
+	/// Default seconds between journal writes.
+	static const float DEFAULT_JOURNAL_INTERVAL = 30.0f;
+	/// Batch header: generation, size and checksum.
+	static const unsigned JOURNAL_BATCH_HEADER = 12;
+
+	static unsigned Checksum(const unsigned char* data, unsigned size)
+	{
+		unsigned hash = 0;
+		for (unsigned i = 0; i < size; ++i)
+			hash = SDBMHash(hash, data[i]);
+		return hash;
+	}
+
+	/// Write a record type and reserve its size. Return the size position for EndRecord().
+	static unsigned BeginRecord(VectorBuffer& batch, JournalRecordType type)
+	{
+		batch.WriteUByte((unsigned char)type);
+		unsigned sizePosition = batch.GetPosition();
+		batch.WriteUInt(0);
+		return sizePosition;
+	}
+
+	static void EndRecord(VectorBuffer& batch, unsigned sizePosition)
+	{
+		unsigned end = batch.GetPosition();
+		batch.Seek(sizePosition);
+		batch.WriteUInt(end - sizePosition - sizeof(unsigned));
+		batch.Seek(end);
+	}
+
+	static CreateMode GetCreateMode(unsigned id)
+	{
+		return id < FIRST_LOCAL_ID ? REPLICATED : LOCAL;
+	}
+
+	SceneJournal::SceneJournal(Context* context, const String& path) : Object(context),
+		snapshotFileName_(AddTrailingSlash(path) + "Autosave.bin"),
+		journalFileName_(AddTrailingSlash(path) + "Autosave.journal"),
+		// Increasing across sessions, so a journal left behind by an older session is never replayed on a newer snapshot
+		generation_(Time::GetTimeSinceEpoch()),
+		snapshotSize_(0),
+		journalSize_(0),
+		numSnapshotObjects_(0),
+		interval_(DEFAULT_JOURNAL_INTERVAL),
+		timer_(0.0f),
+		paused_(false)
+	{
+	}
+
+	SceneJournal::~SceneJournal()
+	{
+		Release();
+	}
+
+	void SceneJournal::Track(Scene* scene)
+	{
+		UnsubscribeFromAllEvents();
+		scene_ = scene;
+		paused_ = false;
+		if (!scene)
+			return;
+
+		if (!IsStarted() && !Run())
+		{
+			LOGERROR("Could not start the autosave thread");
+			scene_.Reset();
+			return;
+		}
+
+		Compact();
+		SubscribeToSceneEvents();
+	}
+
+	void SceneJournal::Release()
+	{
+		UnsubscribeFromAllEvents();
+		scene_.Reset();
+		paused_ = false;
+		changes_.Clear();
+		changedNodes_.Clear();
+		changedComponents_.Clear();
+
+		// Writes the queued data before the thread exits
+		Stop();
+
+		FileSystem* fileSystem = GetSubsystem<FileSystem>();
+		if (fileSystem->FileExists(journalFileName_))
+			fileSystem->Delete(journalFileName_);
+		if (fileSystem->FileExists(snapshotFileName_))
+			fileSystem->Delete(snapshotFileName_);
+	}
+
+	void SceneJournal::Pause()
+	{
+		if (!scene_ || paused_)
+			return;
+
+		// The edits made before the simulation stay recoverable, the simulated changes are never written
+		Flush();
+		UnsubscribeFromAllEvents();
+		paused_ = true;
+	}
+
+	void SceneJournal::Resume()
+	{
+		if (!scene_ || !paused_)
+			return;
+
+		paused_ = false;
+		timer_ = 0.0f;
+		SubscribeToSceneEvents();
+	}
+
+	void SceneJournal::SubscribeToSceneEvents()
+	{
+		Scene* scene = scene_;
+		SubscribeToEvent(E_UPDATE, HANDLER(SceneJournal, HandleUpdate));
+		SubscribeToEvent(scene, E_NODEADDED, HANDLER(SceneJournal, HandleSceneChanged));
+		SubscribeToEvent(scene, E_NODEREMOVED, HANDLER(SceneJournal, HandleSceneChanged));
+		SubscribeToEvent(scene, E_COMPONENTADDED, HANDLER(SceneJournal, HandleSceneChanged));
+		SubscribeToEvent(scene, E_COMPONENTREMOVED, HANDLER(SceneJournal, HandleSceneChanged));
+		SubscribeToEvent(scene, E_NODENAMECHANGED, HANDLER(SceneJournal, HandleObjectChanged));
+		SubscribeToEvent(scene, E_NODEENABLEDCHANGED, HANDLER(SceneJournal, HandleObjectChanged));
+		SubscribeToEvent(scene, E_COMPONENTENABLEDCHANGED, HANDLER(SceneJournal, HandleObjectChanged));
+		SubscribeToEvent(AEE_BOOLVARCHANGED, HANDLER(SceneJournal, HandleAttributeEdited));
+		SubscribeToEvent(AEE_STRINGVARCHANGED, HANDLER(SceneJournal, HandleAttributeEdited));
+		SubscribeToEvent(AEE_NUMBERVARCHANGED, HANDLER(SceneJournal, HandleAttributeEdited));
+		SubscribeToEvent(AEE_ENUMVARCHANGED, HANDLER(SceneJournal, HandleAttributeEdited));
+		SubscribeToEvent(AEE_RESREFVARCHANGED, HANDLER(SceneJournal, HandleAttributeEdited));
+	}
+
+	void SceneJournal::MarkDirty(Node* node)
+	{
+		if (!paused_ && node && !node->IsTemporary() && node->GetScene() == scene_)
+			changedNodes_.Insert(node->GetID());
+	}
+
+	void SceneJournal::MarkDirty(Component* component)
+	{
+		if (!paused_ && component && !component->IsTemporary() && component->GetScene() == scene_)
+			changedComponents_.Insert(component->GetID());
+	}
+
+	void SceneJournal::Flush()
+	{
+		timer_ = 0.0f;
+		Scene* scene = scene_;
+		if (!scene || (changes_.Empty() && changedNodes_.Empty() && changedComponents_.Empty()))
+			return;
+
+		// Replaying changes to most of the scene costs more than a new snapshot
+		if ((changes_.Size() + changedNodes_.Size() + changedComponents_.Size()) * 2 > numSnapshotObjects_)
+		{
+			Compact();
+			return;
+		}
+
+		HiresTimer timer;
+		batch_.Clear();
+		unsigned numRecords = 0;
+
+		for (unsigned i = 0; i < changes_.Size(); ++i)
+		{
+			const PendingChange& change = changes_[i];
+			switch (change.type_)
+			{
+			case JR_NODEADDED:
+			{
+				// Written as it is now, objects added to it later in the interval come along
+				Node* node = scene->GetNode(change.id_);
+				if (!node || !node->GetParent())
+					break;
+				unsigned sizePosition = BeginRecord(batch_, JR_NODEADDED);
+				batch_.WriteUInt(node->GetParent()->GetID());
+				node->Save(batch_);
+				EndRecord(batch_, sizePosition);
+				++numRecords;
+				break;
+			}
+
+			case JR_COMPONENTADDED:
+			{
+				Component* component = scene->GetComponent(change.id_);
+				if (!component || !component->GetNode())
+					break;
+				unsigned sizePosition = BeginRecord(batch_, JR_COMPONENTADDED);
+				batch_.WriteUInt(component->GetNode()->GetID());
+				component->Save(batch_);
+				EndRecord(batch_, sizePosition);
+				++numRecords;
+				break;
+			}
+
+			default:
+			{
+				unsigned sizePosition = BeginRecord(batch_, change.type_);
+				batch_.WriteUInt(change.id_);
+				EndRecord(batch_, sizePosition);
+				++numRecords;
+				break;
+			}
+			}
+		}
+
+		for (HashSet<unsigned>::ConstIterator i = changedNodes_.Begin(); i != changedNodes_.End(); ++i)
+		{
+			Node* node = scene->GetNode(*i);
+			if (!node)
+				continue;
+			unsigned sizePosition = BeginRecord(batch_, JR_NODECHANGED);
+			batch_.WriteUInt(node->GetID());
+			// Attributes only, the components and children are recorded separately
+			node->Serializable::Save(batch_);
+			EndRecord(batch_, sizePosition);
+			++numRecords;
+		}
+
+		for (HashSet<unsigned>::ConstIterator i = changedComponents_.Begin(); i != changedComponents_.End(); ++i)
+		{
+			Component* component = scene->GetComponent(*i);
+			if (!component)
+				continue;
+			unsigned sizePosition = BeginRecord(batch_, JR_COMPONENTCHANGED);
+			component->Save(batch_);
+			EndRecord(batch_, sizePosition);
+			++numRecords;
+		}
+
+		changes_.Clear();
+		changedNodes_.Clear();
+		changedComponents_.Clear();
+
+		if (journalSize_ + batch_.GetSize() > snapshotSize_)
+		{
+			Compact();
+			return;
+		}
+
+		SharedPtr<JournalWrite> write(new JournalWrite());
+		write->snapshot_ = false;
+		write->data_.WriteUInt(generation_);
+		write->data_.WriteUInt(batch_.GetSize());
+		write->data_.WriteUInt(Checksum(batch_.GetData(), batch_.GetSize()));
+		write->data_.Write(batch_.GetData(), batch_.GetSize());
+		journalSize_ += write->data_.GetSize();
+		QueueWrite(write);
+
+		LOGDEBUGF("Autosave journal: %u records, %u bytes in %.2f ms", numRecords, batch_.GetSize(), (float)timer.GetUSec(false) / 1000.0f);
+	}
+
+	void SceneJournal::Compact()
+	{
+		Scene* scene = scene_;
+		if (!scene)
+			return;
+
+		HiresTimer timer;
+		SharedPtr<JournalWrite> write(new JournalWrite());
+		write->snapshot_ = true;
+		write->data_.WriteUInt(++generation_);
+		if (!scene->Save(write->data_))
+		{
+			LOGERROR("Could not serialize the scene for autosave");
+			return;
+		}
+
+		PODVector<Node*> nodes;
+		scene->GetChildren(nodes, true);
+		numSnapshotObjects_ = nodes.Size() + scene->GetComponents().Size();
+		for (unsigned i = 0; i < nodes.Size(); ++i)
+			numSnapshotObjects_ += nodes[i]->GetNumComponents();
+
+		snapshotSize_ = write->data_.GetSize();
+		journalSize_ = 0;
+		changes_.Clear();
+		changedNodes_.Clear();
+		changedComponents_.Clear();
+		timer_ = 0.0f;
+		QueueWrite(write);
+
+		LOGINFOF("Autosave snapshot: %u KB in %.1f ms", snapshotSize_ / 1024, (float)timer.GetUSec(false) / 1000.0f);
+	}
+
+	void SceneJournal::QueueWrite(JournalWrite* write)
+	{
+		MutexLock lock(writeMutex_);
+		writes_.Push(SharedPtr<JournalWrite>(write));
+	}
+
+	bool SceneJournal::HasRecovery() const
+	{
+		return GetSubsystem<FileSystem>()->FileExists(snapshotFileName_);
+	}
+
+	bool SceneJournal::Recover(Scene* scene)
+	{
+		if (!scene)
+			return false;
+
+		File snapshot(context_);
+		if (!snapshot.Open(snapshotFileName_, FILE_READ))
+		{
+			LOGERRORF("Could not open autosave snapshot %s", snapshotFileName_.CString());
+			return false;
+		}
+
+		HiresTimer timer;
+		unsigned generation = snapshot.ReadUInt();
+		if (!scene->Load(snapshot))
+		{
+			LOGERROR("Could not load the autosave snapshot");
+			return false;
+		}
+
+		unsigned numBatches = 0;
+		unsigned numRecords = 0;
+		File journal(context_);
+		if (GetSubsystem<FileSystem>()->FileExists(journalFileName_) && journal.Open(journalFileName_, FILE_READ))
+		{
+			VectorBuffer batch;
+			while (journal.GetPosition() + JOURNAL_BATCH_HEADER <= journal.GetSize())
+			{
+				unsigned batchGeneration = journal.ReadUInt();
+				unsigned size = journal.ReadUInt();
+				unsigned checksum = journal.ReadUInt();
+				// A batch cut short by the crash ends the replay
+				if (journal.GetPosition() + size > journal.GetSize())
+					break;
+				batch.SetData(journal, size);
+				if (Checksum(batch.GetData(), size) != checksum)
+					break;
+				if (batchGeneration < generation)
+					continue;
+
+				numRecords += ApplyBatch(scene, batch);
+				++numBatches;
+			}
+		}
+
+		LOGINFOF("Recovered autosave: snapshot and %u journal batches with %u records in %.1f ms", numBatches, numRecords,
+			(float)timer.GetUSec(false) / 1000.0f);
+		return true;
+	}
+
+	unsigned SceneJournal::ApplyBatch(Scene* scene, VectorBuffer& batch)
+	{
+		unsigned numRecords = 0;
+		while (!batch.IsEof())
+		{
+			JournalRecordType type = (JournalRecordType)batch.ReadUByte();
+			unsigned size = batch.ReadUInt();
+			MemoryBuffer record(batch.GetData() + batch.GetPosition(), size);
+			batch.Seek(batch.GetPosition() + size);
+
+			switch (type)
+			{
+			case JR_NODEADDED:
+			{
+				Node* parent = scene->GetNode(record.ReadUInt());
+				// Node::Load() reads the ID again
+				unsigned position = record.GetPosition();
+				unsigned id = record.ReadUInt();
+				record.Seek(position);
+				if (!parent)
+					break;
+				Node* existing = scene->GetNode(id);
+				if (existing)
+					existing->Remove();
+				Node* node = parent->CreateChild(String::EMPTY, GetCreateMode(id), id);
+				if (node->Load(record))
+					++numRecords;
+				break;
+			}
+
+			case JR_NODEREMOVED:
+			{
+				Node* node = scene->GetNode(record.ReadUInt());
+				if (node && node != scene)
+				{
+					node->Remove();
+					++numRecords;
+				}
+				break;
+			}
+
+			case JR_NODECHANGED:
+			{
+				Node* node = scene->GetNode(record.ReadUInt());
+				if (node && node->Serializable::Load(record))
+				{
+					node->ApplyAttributes();
+					++numRecords;
+				}
+				break;
+			}
+
+			case JR_COMPONENTADDED:
+			case JR_COMPONENTCHANGED:
+			{
+				Node* node = type == JR_COMPONENTADDED ? scene->GetNode(record.ReadUInt()) : NULL;
+				// Skip the type and ID written by Component::Save()
+				StringHash componentType = record.ReadStringHash();
+				unsigned id = record.ReadUInt();
+				Component* component = scene->GetComponent(id);
+				if (!component && node)
+					component = node->CreateComponent(componentType, GetCreateMode(id), id);
+				if (component && component->Load(record))
+				{
+					component->ApplyAttributes();
+					++numRecords;
+				}
+				break;
+			}
+
+			case JR_COMPONENTREMOVED:
+			{
+				Component* component = scene->GetComponent(record.ReadUInt());
+				if (component)
+				{
+					component->Remove();
+					++numRecords;
+				}
+				break;
+			}
+			}
+		}
+		return numRecords;
+	}
+
+	void SceneJournal::ThreadFunction()
+	{
+		Vector<SharedPtr<JournalWrite> > writes;
+		for (;;)
+		{
+			// Checked before taking the queue, so everything queued before Stop() is written
+			bool stop = !shouldRun_;
+			{
+				MutexLock lock(writeMutex_);
+				writes.Swap(writes_);
+			}
+
+			for (unsigned i = 0; i < writes.Size(); ++i)
+			{
+				JournalWrite* write = writes[i];
+				if (write->snapshot_)
+				{
+					String tempFileName = snapshotFileName_ + ".tmp";
+					bool success;
+					{
+						File file(context_);
+						success = file.Open(tempFileName, FILE_WRITE) && file.Write(write->data_.GetData(), write->data_.GetSize()) == write->data_.GetSize() &&
+							SyncFile(file);
+					}
+					if (success && ReplaceFile(tempFileName, snapshotFileName_))
+					{
+						// The batches so far are part of the new snapshot
+						journalFile_ = new File(context_, journalFileName_, FILE_WRITE);
+					}
+					else
+						journalFile_.Reset();
+				}
+				else if (journalFile_ && journalFile_->IsOpen())
+				{
+					journalFile_->Write(write->data_.GetData(), write->data_.GetSize());
+					SyncFile(*journalFile_);
+				}
+			}
+
+			if (stop)
+				break;
+			if (writes.Empty())
+				Time::Sleep(JOURNAL_WRITER_SLEEP);
+			writes.Clear();
+		}
+
+		journalFile_.Reset();
+	}
+
+	void SceneJournal::HandleUpdate(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace Update;
+
+		timer_ += eventData[P_TIMESTEP].GetFloat();
+		if (timer_ >= interval_)
+			Flush();
+	}
+
+	void SceneJournal::HandleSceneChanged(StringHash eventType, VariantMap& eventData)
+	{
+		PendingChange change;
+		if (eventType == E_NODEADDED || eventType == E_NODEREMOVED)
+		{
+			using namespace NodeAdded;
+
+			Node* node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+			if (node->IsTemporary())
+				return;
+			change.type_ = eventType == E_NODEADDED ? JR_NODEADDED : JR_NODEREMOVED;
+			change.id_ = node->GetID();
+		}
+		else
+		{
+			using namespace ComponentAdded;
+
+			Component* component = static_cast<Component*>(eventData[P_COMPONENT].GetPtr());
+			if (component->IsTemporary())
+				return;
+			change.type_ = eventType == E_COMPONENTADDED ? JR_COMPONENTADDED : JR_COMPONENTREMOVED;
+			change.id_ = component->GetID();
+		}
+		changes_.Push(change);
+	}
+
+	void SceneJournal::HandleObjectChanged(StringHash eventType, VariantMap& eventData)
+	{
+		if (eventType == E_COMPONENTENABLEDCHANGED)
+		{
+			using namespace ComponentEnabledChanged;
+			MarkDirty(static_cast<Component*>(eventData[P_COMPONENT].GetPtr()));
+		}
+		else
+		{
+			using namespace NodeNameChanged;
+			MarkDirty(static_cast<Node*>(eventData[P_NODE].GetPtr()));
+		}
+	}
+
+	void SceneJournal::HandleAttributeEdited(StringHash eventType, VariantMap& eventData)
+	{
+		EditorSelection* selection = GetSubsystem<EditorSelection>();
+		if (!selection)
+			return;
+
+		Vector<Node*>& nodes = selection->GetEditNodes();
+		for (unsigned i = 0; i < nodes.Size(); ++i)
+			MarkDirty(nodes[i]);
+		Vector<Component*>& components = selection->GetEditComponents();
+		for (unsigned i = 0; i < components.Size(); ++i)
+			MarkDirty(components[i]);
+	}
+}
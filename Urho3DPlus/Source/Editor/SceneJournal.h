@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+#include "../Container/HashSet.h"
+#include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
+
+namespace Urho3D
+{
+	class Component;
+	class File;
+	class Node;
+	class Scene;
+
+	/// Autosave journal record types.
+	enum JournalRecordType
+	{
+		JR_NODEADDED = 0,
+		JR_NODEREMOVED,
+		JR_NODECHANGED,
+		JR_COMPONENTADDED,
+		JR_COMPONENTREMOVED,
+		JR_COMPONENTCHANGED
+	};
+
+	/// Data handed to the journal writer thread.
+	struct JournalWrite : public RefCounted
+	{
+		/// Full scene snapshot, otherwise a batch of records to append.
+		bool snapshot_;
+		/// Serialized data.
+		VectorBuffer data_;
+	};
+
+	/// Crash recovery autosave. Changed nodes and components are appended to a journal file on a worker thread, which is compacted into a full scene snapshot when it outgrows it.
+	class SceneJournal : public Object, public Thread
+	{
+		OBJECT(SceneJournal);
+	public:
+		/// Construct with the directory for the autosave files.
+		SceneJournal(Context* context, const String& path);
+		/// Destruct. Wait for the writes and remove the autosave files, a clean shutdown needs no recovery.
+		virtual ~SceneJournal();
+
+		/// Start recording a scene from a fresh snapshot.
+		void Track(Scene* scene);
+		/// Stop recording, wait for the writes and remove the autosave files.
+		void Release();
+		/// Write the recorded changes and stop recording while the scene simulates, keeping the autosave files.
+		void Pause();
+		/// Record again after Pause(). The scene must be as it was when paused, otherwise Track() it again.
+		void Resume();
+		/// Record a change the scene sends no event for, such as a transform edit.
+		void MarkDirty(Node* node);
+		void MarkDirty(Component* component);
+		/// Write the recorded changes now.
+		void Flush();
+		/// Set seconds between journal writes.
+		void SetInterval(float interval) { interval_ = interval; }
+
+		/// Return whether recording is paused.
+		bool IsPaused() const { return paused_; }
+		/// Return whether autosave files of an earlier session exist.
+		bool HasRecovery() const;
+		/// Load the autosave snapshot into a scene and replay the journal on top. Return true on success.
+		bool Recover(Scene* scene);
+
+		/// Write queued snapshots and batches. Called on the worker thread.
+		virtual void ThreadFunction();
+
+	protected:
+		struct PendingChange
+		{
+			/// Record type.
+			JournalRecordType type_;
+			/// Node or component ID.
+			unsigned id_;
+		};
+
+		/// Serialize the whole scene and queue it as the new snapshot.
+		void Compact();
+		/// Queue data for the worker thread.
+		void QueueWrite(JournalWrite* write);
+		/// Subscribe to the changes of the recorded scene.
+		void SubscribeToSceneEvents();
+		/// Apply one journal batch to a scene. Return number of records applied.
+		unsigned ApplyBatch(Scene* scene, VectorBuffer& batch);
+		/// Write the recorded changes every interval.
+		void HandleUpdate(StringHash eventType, VariantMap& eventData);
+		/// Record structural changes.
+		void HandleSceneChanged(StringHash eventType, VariantMap& eventData);
+		/// Record node and component changes.
+		void HandleObjectChanged(StringHash eventType, VariantMap& eventData);
+		/// Inspector edits apply to the edited nodes and components.
+		void HandleAttributeEdited(StringHash eventType, VariantMap& eventData);
+
+		/// Autosave file names.
+		String snapshotFileName_;
+		String journalFileName_;
+		/// Recorded scene.
+		WeakPtr<Scene> scene_;
+		/// Added and removed nodes and components in order.
+		PODVector<PendingChange> changes_;
+		/// Nodes and components with changed attributes.
+		HashSet<unsigned> changedNodes_;
+		HashSet<unsigned> changedComponents_;
+		/// Reused batch buffer.
+		VectorBuffer batch_;
+		/// Snapshot generation, batches of older generations are ignored when replaying.
+		unsigned generation_;
+		/// Snapshot size and journal size since, in bytes.
+		unsigned snapshotSize_;
+		unsigned journalSize_;
+		/// Nodes and components in the scene at the snapshot.
+		unsigned numSnapshotObjects_;
+		/// Seconds between journal writes and time since the last one.
+		float interval_;
+		float timer_;
+		/// Recording paused flag.
+		bool paused_;
+
+		/// Writes waiting for the worker thread.
+		Vector<SharedPtr<JournalWrite> > writes_;
+		Mutex writeMutex_;
+		/// Journal file, used by the worker thread only.
+		SharedPtr<File> journalFile_;
+	};
+}
@@ -0,0 +1,135 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "SceneSaver.h"
+#include "../Core/CoreEvents.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../Scene/Scene.h"
+
+#include <cstdio>
+#ifdef WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Urho3D
+{
+	bool SyncFile(File& file)
+	{
+		FILE* handle = (FILE*)file.GetHandle();
+		if (!handle || fflush(handle) != 0)
+			return false;
+#ifdef WIN32
+		return _commit(_fileno(handle)) == 0;
+#else
+		return fsync(fileno(handle)) == 0;
+#endif
+	}
+
+	bool ReplaceFile(const String& source, const String& dest)
+	{
+#ifdef WIN32
+		return MoveFileExW(GetWideNativePath(source).CString(), GetWideNativePath(dest).CString(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return rename(GetNativePath(source).CString(), GetNativePath(dest).CString()) == 0;
+#endif
+	}
+
+	SceneSaver::SceneSaver(Context* context) : Object(context),
+		serializeTime_(0),
+		writeTime_(0),
+		finished_(false),
+		success_(false)
+	{
+	}
+
+	SceneSaver::~SceneSaver()
+	{
+		Complete();
+	}
+
+	bool SceneSaver::Save(Scene* scene, const String& fileName)
+	{
+		Complete();
+		if (!scene || fileName.Empty())
+			return false;
+
+		timer_.Reset();
+		// Keep the buffer capacity for the next save
+		data_.Clear();
+		bool success = GetExtension(fileName) != ".xml" ? scene->Save(data_) : scene->SaveXML(data_);
+		serializeTime_ = timer_.GetUSec(false);
+		if (!success)
+		{
+			LOGERRORF("Could not serialize scene for saving to %s", fileName.CString());
+			return false;
+		}
+
+		fileName_ = fileName;
+		tempFileName_ = fileName + ".tmp";
+		finished_ = false;
+		success_ = false;
+		if (!Run())
+		{
+			LOGERROR("Could not start the scene save thread");
+			return false;
+		}
+
+		SubscribeToEvent(E_UPDATE, HANDLER(SceneSaver, HandleUpdate));
+		return true;
+	}
+
+	void SceneSaver::Complete()
+	{
+		if (!IsStarted())
+			return;
+
+		// Joins the worker, it does not check shouldRun_
+		Stop();
+		UnsubscribeFromEvent(E_UPDATE);
+
+		if (success_)
+		{
+			LOGINFOF("Saved scene %s, %u KB in %.1f ms: %.1f ms serializing on the main thread, %.1f ms writing", fileName_.CString(),
+				data_.GetSize() / 1024, (float)timer_.GetUSec(false) / 1000.0f, (float)serializeTime_ / 1000.0f, (float)writeTime_ / 1000.0f);
+		}
+		else
+			LOGERRORF("Could not write scene to %s", fileName_.CString());
+
+		using namespace SceneSaveFinished;
+
+		VariantMap& eventData = GetEventDataMap();
+		eventData[P_FILENAME] = fileName_;
+		eventData[P_SUCCESS] = (bool)success_;
+		SendEvent(E_SCENESAVEFINISHED, eventData);
+	}
+
+	void SceneSaver::ThreadFunction()
+	{
+		HiresTimer timer;
+		bool success;
+		{
+			File file(context_);
+			success = file.Open(tempFileName_, FILE_WRITE) && file.Write(data_.GetData(), data_.GetSize()) == data_.GetSize() && SyncFile(file);
+		}
+
+		// The target is only touched once the new file is complete
+		if (success)
+			success = ReplaceFile(tempFileName_, fileName_);
+		if (!success)
+			remove(GetNativePath(tempFileName_).CString());
+
+		writeTime_ = timer.GetUSec(false);
+		success_ = success;
+		finished_ = true;
+	}
+
+	void SceneSaver::HandleUpdate(StringHash eventType, VariantMap& eventData)
+	{
+		if (finished_)
+			Complete();
+	}
+}
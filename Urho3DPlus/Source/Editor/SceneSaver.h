@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../IO/VectorBuffer.h"
+
+namespace Urho3D
+{
+	class File;
+	class Scene;
+
+	/// Flush an open file's contents to the disk. Return true on success.
+	bool SyncFile(File& file);
+	/// Rename a file over an existing one in a single step. Return true on success.
+	bool ReplaceFile(const String& source, const String& dest);
+
+	/// Background scene save finished.
+	EVENT(E_SCENESAVEFINISHED, SceneSaveFinished)
+	{
+		PARAM(P_FILENAME, FileName);                  // String
+		PARAM(P_SUCCESS, Success);                    // bool
+	}
+
+	/// Saves a scene from a memory snapshot on a worker thread. The file is written next to the target and renamed over it, so the old file stays intact until the new one is complete.
+	class SceneSaver : public Object, public Thread
+	{
+		OBJECT(SceneSaver);
+	public:
+		/// Construct.
+		SceneSaver(Context* context);
+		/// Destruct. Wait for a save in progress.
+		virtual ~SceneSaver();
+
+		/// Serialize the scene on the calling thread and start writing it. Waits for a previous save first. Return true if the write started.
+		bool Save(Scene* scene, const String& fileName);
+		/// Wait for a save in progress and send its finished event.
+		void Complete();
+		/// Return whether a save is in progress.
+		bool IsSaving() const { return IsStarted(); }
+
+		/// Write and rename the file. Called on the worker thread.
+		virtual void ThreadFunction();
+
+	protected:
+		/// Finish the save when the worker is done.
+		void HandleUpdate(StringHash eventType, VariantMap& eventData);
+
+		/// Serialized scene.
+		VectorBuffer data_;
+		/// Target and temporary file names.
+		String fileName_;
+		String tempFileName_;
+		/// Main thread serialization time in microseconds.
+		long long serializeTime_;
+		/// Worker write time in microseconds.
+		volatile long long writeTime_;
+		/// Set by the worker when the write and rename are done.
+		volatile bool finished_;
+		volatile bool success_;
+		/// Save duration.
+		HiresTimer timer_;
+	};
+}
@@ -0,0 +1,382 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "SceneSnapshot.h"
+#include "../Core/Timer.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+#include "../Scene/Component.h"
+#include "AttributeVariableEvents.h"
+
+namespace Urho3D
+{
+	/// Component types whose attributes the simulation changes, their data is kept for incremental reverts.
+	static const StringHash simulatedComponentTypes[] = {
+		StringHash("RigidBody"),
+		StringHash("AnimatedModel"),
+		StringHash("AnimationController"),
+		StringHash("ParticleEmitter"),
+		StringHash("SoundSource"),
+		StringHash("SoundSource3D"),
+		StringHash("ScriptInstance"),
+		StringHash("LuaScriptInstance")
+	};
+
+	/// Node attributes restored one by one in incremental reverts, left out of the node attribute hash.
+	static const String restoredNodeAttributes[] = {
+		"Is Enabled",
+		"Position",
+		"Rotation",
+		"Scale"
+	};
+
+	static bool IsSimulatedComponent(Component* component)
+	{
+		StringHash type = component->GetType();
+		for (unsigned i = 0; i < sizeof(simulatedComponentTypes) / sizeof(simulatedComponentTypes[0]); ++i)
+		{
+			if (simulatedComponentTypes[i] == type)
+				return true;
+		}
+		return false;
+	}
+
+	SceneSnapshot::SceneSnapshot(Context* context) : Object(context),
+		fullRevertNeeded_(false)
+	{
+	}
+
+	SceneSnapshot::~SceneSnapshot()
+	{
+	}
+
+	bool SceneSnapshot::Take(Scene* scene)
+	{
+		Clear();
+		if (!scene)
+			return false;
+
+		HiresTimer timer;
+		if (!scene->Save(sceneData_))
+		{
+			LOGERROR("Could not take the scene snapshot, the scene will not be reverted");
+			Clear();
+			return false;
+		}
+
+		scene->Serializable::Save(sceneAttributes_);
+
+		PODVector<Node*> nodes;
+		scene->GetChildren(nodes, true);
+		nodes.Insert(0, scene);
+
+		nodes_.Resize(nodes.Size());
+		for (unsigned i = 0; i < nodes.Size(); ++i)
+		{
+			Node* node = nodes[i];
+			NodeState& state = nodes_[i];
+			state.id_ = node->GetID();
+			state.parentID_ = node->GetParent() ? node->GetParent()->GetID() : 0;
+			state.position_ = node->GetPosition();
+			state.rotation_ = node->GetRotation();
+			state.scale_ = node->GetScale();
+			state.enabled_ = node->IsEnabled();
+			state.attributeHash_ = HashAttributes(node, state.attributeSize_);
+			nodeIndices_[state.id_] = i;
+
+			const Vector<SharedPtr<Component> >& components = node->GetComponents();
+			for (unsigned j = 0; j < components.Size(); ++j)
+			{
+				Component* component = components[j];
+				componentIDs_.Insert(component->GetID());
+
+				ComponentState componentState;
+				componentState.id_ = component->GetID();
+				componentState.offset_ = componentData_.GetSize();
+				componentState.size_ = 0;
+				componentState.attributeHash_ = 0;
+				componentState.attributeSize_ = 0;
+				// Simulated types are always reloaded, the others only checked for changes
+				if (IsSimulatedComponent(component))
+				{
+					component->Save(componentData_);
+					componentState.size_ = componentData_.GetSize() - componentState.offset_;
+				}
+				else
+					componentState.attributeHash_ = HashAttributes(component, componentState.attributeSize_);
+				components_.Push(componentState);
+			}
+		}
+
+		scene_ = scene;
+		SubscribeToEvent(scene, E_NODEADDED, HANDLER(SceneSnapshot, HandleSceneStructureChanged));
+		SubscribeToEvent(scene, E_NODEREMOVED, HANDLER(SceneSnapshot, HandleSceneStructureChanged));
+		SubscribeToEvent(scene, E_COMPONENTADDED, HANDLER(SceneSnapshot, HandleSceneStructureChanged));
+		SubscribeToEvent(scene, E_COMPONENTREMOVED, HANDLER(SceneSnapshot, HandleSceneStructureChanged));
+		SubscribeToEvent(AEE_BOOLVARCHANGED, HANDLER(SceneSnapshot, HandleAttributeEdited));
+		SubscribeToEvent(AEE_STRINGVARCHANGED, HANDLER(SceneSnapshot, HandleAttributeEdited));
+		SubscribeToEvent(AEE_NUMBERVARCHANGED, HANDLER(SceneSnapshot, HandleAttributeEdited));
+		SubscribeToEvent(AEE_ENUMVARCHANGED, HANDLER(SceneSnapshot, HandleAttributeEdited));
+		SubscribeToEvent(AEE_RESREFVARCHANGED, HANDLER(SceneSnapshot, HandleAttributeEdited));
+
+		LOGINFOF("Scene snapshot for revert: %u KB in %.1f ms", GetMemoryUse() / 1024, (float)timer.GetUSec(false) / 1000.0f);
+		return true;
+	}
+
+	bool SceneSnapshot::CanRevertIncrementally()
+	{
+		Scene* scene = scene_;
+		if (!scene || fullRevertNeeded_)
+			return false;
+
+		// Snapshot nodes that were removed must have been reparented back, removed components cannot be restored
+		for (unsigned i = 0; i < removedNodes_.Size(); ++i)
+		{
+			Node* node = scene->GetNode(removedNodes_[i]);
+			if (!node || !node->GetParent())
+				return false;
+
+			HashMap<unsigned, unsigned>::ConstIterator j = nodeIndices_.Find(removedNodes_[i]);
+			if (j == nodeIndices_.End() || nodes_[j->second_].parentID_ != node->GetParent()->GetID())
+				return false;
+		}
+
+		for (unsigned i = 0; i < removedComponents_.Size(); ++i)
+		{
+			if (!scene->GetComponent(removedComponents_[i]))
+				return false;
+		}
+
+		// Anything else the simulation changed, like names, variables, materials or script set attributes, is only restored by a full revert
+		// The scene node comes first, its attributes are reloaded as a whole
+		unsigned size;
+		for (unsigned i = 1; i < nodes_.Size(); ++i)
+		{
+			const NodeState& state = nodes_[i];
+			Node* node = scene->GetNode(state.id_);
+			if (node && (HashAttributes(node, size) != state.attributeHash_ || size != state.attributeSize_))
+			{
+				LOGINFOF("Node %u changed during the simulation, reverting the whole scene", state.id_);
+				return false;
+			}
+		}
+
+		for (unsigned i = 0; i < components_.Size(); ++i)
+		{
+			const ComponentState& state = components_[i];
+			if (state.size_)
+				continue;
+			Component* component = scene->GetComponent(state.id_);
+			if (component && (HashAttributes(component, size) != state.attributeHash_ || size != state.attributeSize_))
+			{
+				LOGINFOF("%s %u changed during the simulation, reverting the whole scene", component->GetTypeName().CString(), state.id_);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool SceneSnapshot::RevertIncremental()
+	{
+		Scene* scene = scene_;
+		if (!scene)
+			return false;
+
+		// The removals below must not be recorded
+		UnsubscribeFromAllEvents();
+
+		HiresTimer timer;
+		unsigned numRemoved = 0;
+		unsigned numRestored = 0;
+
+		for (unsigned i = createdNodes_.Size(); i > 0; --i)
+		{
+			Node* node = scene->GetNode(createdNodes_[i - 1]);
+			if (node)
+			{
+				node->Remove();
+				++numRemoved;
+			}
+		}
+
+		for (unsigned i = createdComponents_.Size(); i > 0; --i)
+		{
+			Component* component = scene->GetComponent(createdComponents_[i - 1]);
+			if (component)
+			{
+				component->Remove();
+				++numRemoved;
+			}
+		}
+
+		for (unsigned i = 0; i < nodes_.Size(); ++i)
+		{
+			const NodeState& state = nodes_[i];
+			Node* node = scene->GetNode(state.id_);
+			if (!node)
+				continue;
+
+			if (node->GetPosition() != state.position_ || node->GetRotation() != state.rotation_ || node->GetScale() != state.scale_)
+			{
+				node->SetTransform(state.position_, state.rotation_, state.scale_);
+				++numRestored;
+			}
+			if (node->IsEnabled() != state.enabled_)
+				node->SetEnabled(state.enabled_);
+		}
+
+		// Transforms first, so rigid bodies end up with both their node and their physics state restored
+		for (unsigned i = 0; i < components_.Size(); ++i)
+		{
+			const ComponentState& state = components_[i];
+			if (!state.size_)
+				continue;
+			Component* component = scene->GetComponent(state.id_);
+			if (!component)
+				continue;
+
+			MemoryBuffer buffer(componentData_.GetData() + state.offset_, state.size_);
+			// Skip the type and ID written by Component::Save()
+			buffer.ReadStringHash();
+			buffer.ReadUInt();
+			if (component->Load(buffer))
+			{
+				component->ApplyAttributes();
+				++numRestored;
+			}
+		}
+
+		// Last, so that the ID counters are restored after the created nodes and components are gone
+		MemoryBuffer sceneAttributes(sceneAttributes_.GetData(), sceneAttributes_.GetSize());
+		scene->Serializable::Load(sceneAttributes);
+
+		LOGINFOF("Scene reverted incrementally: %u objects removed, %u restored in %.1f ms", numRemoved, numRestored,
+			(float)timer.GetUSec(false) / 1000.0f);
+		return true;
+	}
+
+	bool SceneSnapshot::RevertFull()
+	{
+		Scene* scene = scene_;
+		if (!scene || !sceneData_.GetSize())
+			return false;
+
+		UnsubscribeFromAllEvents();
+
+		HiresTimer timer;
+		// Scene::Load() removes the current nodes and components itself
+		sceneData_.Seek(0);
+		if (!scene->Load(sceneData_))
+		{
+			LOGERROR("Could not revert the scene from the snapshot");
+			return false;
+		}
+
+		LOGINFOF("Scene reverted from a %u KB snapshot in %.1f ms", sceneData_.GetSize() / 1024, (float)timer.GetUSec(false) / 1000.0f);
+		return true;
+	}
+
+	void SceneSnapshot::Clear()
+	{
+		UnsubscribeFromAllEvents();
+
+		scene_.Reset();
+		// Keep the buffer capacity for the next snapshot
+		sceneData_.Clear();
+		sceneAttributes_.Clear();
+		componentData_.Clear();
+		nodes_.Clear();
+		nodeIndices_.Clear();
+		components_.Clear();
+		componentIDs_.Clear();
+		createdNodes_.Clear();
+		createdComponents_.Clear();
+		removedNodes_.Clear();
+		removedComponents_.Clear();
+		attributeBuffer_.Clear();
+		fullRevertNeeded_ = false;
+	}
+
+	unsigned SceneSnapshot::GetMemoryUse() const
+	{
+		return sceneData_.GetSize() + sceneAttributes_.GetSize() + componentData_.GetSize() + nodes_.Size() * sizeof(NodeState) + components_.Size() * sizeof(ComponentState);
+	}
+
+	void SceneSnapshot::HandleSceneStructureChanged(StringHash eventType, VariantMap& eventData)
+	{
+		if (eventType == E_NODEADDED)
+		{
+			using namespace NodeAdded;
+
+			// Reparented snapshot nodes are sent as removed and added again
+			unsigned id = static_cast<Node*>(eventData[P_NODE].GetPtr())->GetID();
+			if (!nodeIndices_.Contains(id))
+				createdNodes_.Push(id);
+		}
+		else if (eventType == E_NODEREMOVED)
+		{
+			using namespace NodeRemoved;
+
+			unsigned id = static_cast<Node*>(eventData[P_NODE].GetPtr())->GetID();
+			if (nodeIndices_.Contains(id))
+				removedNodes_.Push(id);
+		}
+		else if (eventType == E_COMPONENTADDED)
+		{
+			using namespace ComponentAdded;
+
+			unsigned id = static_cast<Component*>(eventData[P_COMPONENT].GetPtr())->GetID();
+			if (!componentIDs_.Contains(id))
+				createdComponents_.Push(id);
+		}
+		else if (eventType == E_COMPONENTREMOVED)
+		{
+			using namespace ComponentRemoved;
+
+			unsigned id = static_cast<Component*>(eventData[P_COMPONENT].GetPtr())->GetID();
+			if (componentIDs_.Contains(id))
+				removedComponents_.Push(id);
+		}
+	}
+
+	void SceneSnapshot::HandleAttributeEdited(StringHash eventType, VariantMap& eventData)
+	{
+		fullRevertNeeded_ = true;
+	}
+
+	unsigned SceneSnapshot::HashAttributes(Serializable* serializable, unsigned& size)
+	{
+		attributeBuffer_.Clear();
+
+		const Vector<AttributeInfo>* attributes = serializable->GetAttributes();
+		if (attributes)
+		{
+			bool isNode = dynamic_cast<Node*>(serializable) != 0;
+			for (unsigned i = 0; i < attributes->Size(); ++i)
+			{
+				const AttributeInfo& attr = attributes->At(i);
+				if (!(attr.mode_ & AM_FILE))
+					continue;
+				if (isNode)
+				{
+					bool restored = false;
+					for (unsigned j = 0; j < sizeof(restoredNodeAttributes) / sizeof(restoredNodeAttributes[0]) && !restored; ++j)
+						restored = attr.name_ == restoredNodeAttributes[j];
+					if (restored)
+						continue;
+				}
+				attributeBuffer_.WriteVariantData(serializable->GetAttribute(i));
+			}
+		}
+
+		// FNV-1a
+		size = attributeBuffer_.GetSize();
+		const unsigned char* data = attributeBuffer_.GetData();
+		unsigned hash = 2166136261u;
+		for (unsigned i = 0; i < size; ++i)
+			hash = (hash ^ data[i]) * 16777619u;
+		return hash;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+#include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
+#include "../Math/Quaternion.h"
+
+namespace Urho3D
+{
+	class Scene;
+	class Serializable;
+
+	/// Scene state taken when the simulation starts. Reverts only what the simulation touched, or the whole scene when that cannot be done exactly.
+	class SceneSnapshot : public Object
+	{
+		OBJECT(SceneSnapshot);
+	public:
+		/// Construct.
+		SceneSnapshot(Context* context);
+		/// Destruct.
+		virtual ~SceneSnapshot();
+
+		/// Take the snapshot and start recording changes. Return true on success.
+		bool Take(Scene* scene);
+		/// Return whether the recorded changes can be restored without reloading the scene. Compares the attribute hashes of all other nodes and components.
+		bool CanRevertIncrementally();
+		/// Remove the created nodes and components and restore the transforms and simulated components. Return true on success.
+		bool RevertIncremental();
+		/// Reload the whole scene. Return true on success.
+		bool RevertFull();
+		/// Release the snapshot and stop recording.
+		void Clear();
+
+		/// Return whether a snapshot is held.
+		bool IsValid() const { return scene_.NotNull() && sceneData_.GetSize() > 0; }
+		/// Return total snapshot size in bytes.
+		unsigned GetMemoryUse() const;
+
+	protected:
+		struct NodeState
+		{
+			/// Node ID.
+			unsigned id_;
+			/// Parent node ID.
+			unsigned parentID_;
+			/// Local transform.
+			Vector3 position_;
+			Quaternion rotation_;
+			Vector3 scale_;
+			/// Enabled flag.
+			bool enabled_;
+			/// Hash and size of the other file attributes.
+			unsigned attributeHash_;
+			unsigned attributeSize_;
+		};
+
+		struct ComponentState
+		{
+			/// Component ID.
+			unsigned id_;
+			/// Serialized data in componentData_, simulated types only. Size is 0 for other types.
+			unsigned offset_;
+			unsigned size_;
+			/// Hash and size of the file attributes, other types only.
+			unsigned attributeHash_;
+			unsigned attributeSize_;
+		};
+
+		/// Record created and removed nodes and components.
+		void HandleSceneStructureChanged(StringHash eventType, VariantMap& eventData);
+		/// Attribute edits in the inspector are not tracked per attribute, they need a full revert.
+		void HandleAttributeEdited(StringHash eventType, VariantMap& eventData);
+		/// Hash the file attributes of a node or component, leaving out the node transform and enabled flag. Return the hash and the serialized size.
+		unsigned HashAttributes(Serializable* serializable, unsigned& size);
+
+		/// Scene the snapshot was taken of.
+		WeakPtr<Scene> scene_;
+		/// Whole scene, binary.
+		VectorBuffer sceneData_;
+		/// Attributes of the scene node itself, like the elapsed time and the ID counters, binary.
+		VectorBuffer sceneAttributes_;
+		/// Node transforms and enabled flags.
+		PODVector<NodeState> nodes_;
+		/// Index into nodes_ by node ID.
+		HashMap<unsigned, unsigned> nodeIndices_;
+		/// Components of simulated types, binary.
+		VectorBuffer componentData_;
+		/// All components, with the data of simulated types and the attribute hash of the others.
+		PODVector<ComponentState> components_;
+		/// Scratch for hashing attributes.
+		VectorBuffer attributeBuffer_;
+		/// Component IDs that existed at the snapshot.
+		HashSet<unsigned> componentIDs_;
+		/// Nodes and components created since the snapshot.
+		PODVector<unsigned> createdNodes_;
+		PODVector<unsigned> createdComponents_;
+		/// Snapshot nodes and components removed or reparented since the snapshot.
+		PODVector<unsigned> removedNodes_;
+		PODVector<unsigned> removedComponents_;
+		/// A change was recorded that only a full revert restores.
+		bool fullRevertNeeded_;
+	};
+}
@@ -58,6 +58,7 @@
 #include "ResourcePicker.h"
 #include "AttributeContainer.h"
 #include "UIGlobals.h"
+#include "Utils/StageTimer.h"
 #include "UIUtils.h"
 #include "AttributeVariable.h"
 #include "../Graphics/Graphics.h"
@@ -224,6 +225,8 @@ namespace Urho3D
 
 	void AttributeInspector::Update(bool fullUpdate /*= true*/)
 	{
+		ScopedStageTimer timer(this, STAGE_INSPECTOR);
+
 		attributesDirty_ = false;
 		if (fullUpdate)
 			attributesFullDirty_ = false;
@@ -0,0 +1,766 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "HierarchyList.h"
+#include "../Input/InputEvents.h"
+#include "../IO/Log.h"
+#include "../Resource/XMLFile.h"
+#include "../UI/BorderImage.h"
+#include "../UI/CheckBox.h"
+#include "../UI/Text.h"
+#include "../UI/UIEvents.h"
+#include "UIUtils.h"
+
+namespace Urho3D
+{
+	static const int DEFAULT_ROW_HEIGHT = 16;
+	static const float DOUBLECLICK_INTERVAL = 0.5f;
+	static const StringHash ROW_INDEX_VAR("RowIndex");
+
+	HierarchyList::HierarchyList(Context* context) : ScrollView(context),
+		firstStaleIndex_(0),
+		rowHeight_(DEFAULT_ROW_HEIGHT),
+		visibleDirty_(true),
+		rowsDirty_(true),
+		selectOnClickEnd_(false),
+		filtered_(false),
+		doubleClickTimer_(0.0f),
+		lastClickedItem_(NO_ITEM)
+	{
+		// Rows are positioned by hand, the content element only gives the scroll view its size
+		UIElement* container = new UIElement(context_);
+		container->SetInternal(true);
+		SetContentElement(container);
+
+		SubscribeToEvent(E_UIMOUSECLICK, HANDLER(HierarchyList, HandleUIMouseClick));
+		SubscribeToEvent(E_UIMOUSECLICKEND, HANDLER(HierarchyList, HandleUIMouseClick));
+	}
+
+	HierarchyList::~HierarchyList()
+	{
+	}
+
+	void HierarchyList::RegisterObject(Context* context)
+	{
+		context->RegisterFactory<HierarchyList>();
+		COPY_BASE_ATTRIBUTES(ScrollView);
+	}
+
+	void HierarchyList::Update(float timeStep)
+	{
+		ScrollView::Update(timeStep);
+
+		if (doubleClickTimer_ > 0.0f)
+			doubleClickTimer_ = Max(doubleClickTimer_ - timeStep, 0.0f);
+
+		if (visibleDirty_)
+			UpdateVisibleItems();
+		if (rowsDirty_ || viewPosition_ != rowsViewPosition_ || scrollPanel_->GetSize() != rowsViewSize_)
+			UpdateRows();
+	}
+
+	void HierarchyList::OnKey(int key, int buttons, int qualifiers)
+	{
+		if (selections_.Empty())
+		{
+			ScrollView::OnKey(key, buttons, qualifiers);
+			return;
+		}
+
+		unsigned selection = selections_.Back();
+		switch (key)
+		{
+		case KEY_UP:
+		case KEY_DOWN:
+		{
+			unsigned next = GetVisibleNeighbour(selection, key == KEY_UP ? -1 : 1);
+			if (next != NO_ITEM && next != selection)
+				SetSelection(next);
+			break;
+		}
+
+		case KEY_LEFT:
+		case KEY_RIGHT:
+			Expand(selection, key == KEY_RIGHT);
+			break;
+
+		default:
+			ScrollView::OnKey(key, buttons, qualifiers);
+			break;
+		}
+	}
+
+	unsigned HierarchyList::InsertItem(unsigned index, unsigned parentIndex, const HierarchyListItem& item, const String& title, const String& iconType)
+	{
+		HierarchyListItem newItem = item;
+		newItem.selected_ = false;
+		newItem.matched_ = false;
+		if (parentIndex < items_.Size())
+		{
+			newItem.indent_ = items_[parentIndex].indent_ + 1;
+			index = Max(index, parentIndex + 1);
+		}
+		else
+			newItem.indent_ = 0;
+		index = Min(index, items_.Size());
+
+		StringHash iconHash(iconType);
+		if (!iconTypeIndices_.Contains(iconHash))
+		{
+			iconTypeIndices_[iconHash] = iconTypes_.Size();
+			iconTypes_.Push(iconType);
+		}
+		newItem.icon_ = iconTypeIndices_[iconHash];
+
+		if (freeTitles_.Empty())
+		{
+			newItem.title_ = titles_.Size();
+			titles_.Push(title);
+		}
+		else
+		{
+			newItem.title_ = freeTitles_.Back();
+			freeTitles_.Pop();
+			titles_[newItem.title_] = title;
+		}
+
+		items_.Insert(index, newItem);
+
+		for (unsigned i = 0; i < selections_.Size(); ++i)
+		{
+			if (selections_[i] >= index)
+				++selections_[i];
+		}
+
+		// Items from the new one on have moved down, the item that was at its index included. Appending moves nothing
+		if (index + 1 < items_.Size())
+			firstStaleIndex_ = Min(firstStaleIndex_, index);
+		if (newItem.type_ > ITEM_NONE && newItem.type_ <= ITEM_UI_ELEMENT)
+			index_[newItem.type_][newItem.id_] = index;
+
+		visibleDirty_ = true;
+		return index;
+	}
+
+	void HierarchyList::RemoveItem(unsigned index)
+	{
+		if (index >= items_.Size())
+			return;
+
+		unsigned end = GetChildrenEnd(index);
+		unsigned count = end - index;
+		for (unsigned i = index; i < end; ++i)
+		{
+			const HierarchyListItem& item = items_[i];
+			if (item.type_ > ITEM_NONE && item.type_ <= ITEM_UI_ELEMENT)
+				index_[item.type_].Erase(item.id_);
+			titles_[item.title_].Clear();
+			freeTitles_.Push(item.title_);
+		}
+
+		bool selectionChanged = false;
+		for (unsigned i = selections_.Size(); i-- > 0;)
+		{
+			if (selections_[i] >= end)
+				selections_[i] -= count;
+			else if (selections_[i] >= index)
+			{
+				selections_.Erase(i);
+				selectionChanged = true;
+			}
+		}
+
+		items_.Erase(index, count);
+		// The items after the removed ones have moved up to its index, removing the last items moves nothing
+		if (index < items_.Size())
+			firstStaleIndex_ = Min(firstStaleIndex_, index);
+		visibleDirty_ = true;
+
+		if (selectionChanged)
+			SendSelectionChanged();
+	}
+
+	void HierarchyList::RemoveAllItems()
+	{
+		bool selectionChanged = !selections_.Empty();
+
+		items_.Clear();
+		titles_.Clear();
+		freeTitles_.Clear();
+		selections_.Clear();
+		for (unsigned i = 0; i <= ITEM_UI_ELEMENT; ++i)
+			index_[i].Clear();
+		firstStaleIndex_ = 0;
+		visibleDirty_ = true;
+
+		if (selectionChanged)
+			SendSelectionChanged();
+	}
+
+	void HierarchyList::SetItemTitle(unsigned index, const String& title)
+	{
+		if (index >= items_.Size())
+			return;
+
+		titles_[items_[index].title_] = title;
+		rowsDirty_ = true;
+	}
+
+	void HierarchyList::SetItemEnabled(unsigned index, bool enable)
+	{
+		if (index >= items_.Size())
+			return;
+
+		items_[index].enabled_ = enable;
+		rowsDirty_ = true;
+	}
+
+	void HierarchyList::SetItemColor(int type, const Color& color)
+	{
+		if (type < ITEM_NONE || type > ITEM_UI_ELEMENT)
+			return;
+
+		itemColors_[type] = color;
+		rowsDirty_ = true;
+	}
+
+	void HierarchyList::SetIconStyle(XMLFile* iconStyle)
+	{
+		iconStyle_ = iconStyle;
+		// Styles are applied again on the next bind
+		for (unsigned i = 0; i < rowIcons_.Size(); ++i)
+			rowIcons_[i] = M_MAX_UNSIGNED;
+		rowsDirty_ = true;
+	}
+
+	void HierarchyList::SetRowHeight(int height)
+	{
+		rowHeight_ = Max(height, 1);
+		for (unsigned i = 0; i < rows_.Size(); ++i)
+			rows_[i]->SetFixedHeight(rowHeight_);
+		visibleDirty_ = true;
+	}
+
+	void HierarchyList::SetSelectOnClickEnd(bool enable)
+	{
+		selectOnClickEnd_ = enable;
+	}
+
+	void HierarchyList::SetSelection(unsigned index)
+	{
+		PODVector<unsigned> indices;
+		indices.Push(index);
+		SetSelections(indices);
+		EnsureItemVisibility(index);
+	}
+
+	void HierarchyList::SetSelections(const PODVector<unsigned>& indices)
+	{
+		for (unsigned i = 0; i < selections_.Size(); ++i)
+			items_[selections_[i]].selected_ = false;
+		selections_.Clear();
+
+		for (unsigned i = 0; i < indices.Size(); ++i)
+		{
+			unsigned index = indices[i];
+			if (index < items_.Size() && !items_[index].selected_)
+			{
+				items_[index].selected_ = true;
+				selections_.Push(index);
+			}
+		}
+
+		rowsDirty_ = true;
+		SendSelectionChanged();
+	}
+
+	void HierarchyList::AddSelection(unsigned index)
+	{
+		if (index >= items_.Size() || items_[index].selected_)
+			return;
+
+		items_[index].selected_ = true;
+		selections_.Push(index);
+		rowsDirty_ = true;
+		SendSelectionChanged();
+	}
+
+	void HierarchyList::RemoveSelection(unsigned index)
+	{
+		if (!IsSelected(index))
+			return;
+
+		items_[index].selected_ = false;
+		selections_.Remove(index);
+		rowsDirty_ = true;
+		SendSelectionChanged();
+	}
+
+	void HierarchyList::ToggleSelection(unsigned index)
+	{
+		if (IsSelected(index))
+			RemoveSelection(index);
+		else
+			AddSelection(index);
+	}
+
+	void HierarchyList::ClearSelection()
+	{
+		SetSelections(PODVector<unsigned>());
+	}
+
+	void HierarchyList::SetItemHasChildren(unsigned index, bool enable)
+	{
+		if (index >= items_.Size())
+			return;
+
+		items_[index].hasChildren_ = enable;
+		rowsDirty_ = true;
+	}
+
+	void HierarchyList::Expand(unsigned index, bool enable, bool recursive)
+	{
+		if (index >= items_.Size())
+			return;
+
+		if (enable)
+			Populate(index);
+
+		unsigned end = recursive ? GetChildrenEnd(index) : index + 1;
+		for (unsigned i = index; i < end; ++i)
+		{
+			// Child items populated on the way extend the subtree
+			if (enable && recursive && i > index)
+				end += Populate(i);
+			items_[i].expanded_ = enable;
+		}
+		visibleDirty_ = true;
+	}
+
+	void HierarchyList::ToggleExpand(unsigned index, bool recursive)
+	{
+		Expand(index, !IsExpanded(index), recursive);
+	}
+
+	void HierarchyList::EnsureItemVisibility(unsigned index)
+	{
+		unsigned position = GetVisiblePosition(index);
+		if (position == NO_ITEM)
+			return;
+
+		const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+		int viewHeight = scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_;
+		int top = (int)position * rowHeight_;
+
+		IntVector2 viewPosition = viewPosition_;
+		if (top < viewPosition.y_)
+			viewPosition.y_ = top;
+		else if (top + rowHeight_ > viewPosition.y_ + viewHeight)
+			viewPosition.y_ = top + rowHeight_ - viewHeight;
+		SetViewPosition(viewPosition);
+	}
+
+	void HierarchyList::SetFilter(const PODVector<unsigned>& indices)
+	{
+		for (unsigned i = 0; i < items_.Size(); ++i)
+			items_[i].matched_ = false;
+		for (unsigned i = 0; i < indices.Size(); ++i)
+		{
+			if (indices[i] < items_.Size())
+				items_[indices[i]].matched_ = true;
+		}
+
+		filtered_ = true;
+		visibleDirty_ = true;
+	}
+
+	void HierarchyList::ClearFilter()
+	{
+		if (!filtered_)
+			return;
+
+		filtered_ = false;
+		visibleDirty_ = true;
+	}
+
+	unsigned HierarchyList::GetNumVisibleItems()
+	{
+		if (visibleDirty_)
+			UpdateVisibleItems();
+		return visibleItems_.Size();
+	}
+
+	unsigned HierarchyList::FindItem(int type, unsigned id)
+	{
+		if (type <= ITEM_NONE || type > ITEM_UI_ELEMENT)
+			return NO_ITEM;
+
+		HashMap<unsigned, unsigned>::Iterator i = index_[type].Find(id);
+		if (i == index_[type].End())
+			return NO_ITEM;
+
+		if (i->second_ >= firstStaleIndex_)
+			UpdateIndex();
+
+		// Inserts and removals mark every moved item stale, so a valid index always holds its item
+		const HierarchyListItem& item = items_[i->second_];
+		if (item.type_ != type || item.id_ != id)
+		{
+			LOGERRORF("Hierarchy list index %u of item %u is stale", i->second_, id);
+			return NO_ITEM;
+		}
+		return i->second_;
+	}
+
+	unsigned HierarchyList::GetParentItem(unsigned index) const
+	{
+		if (index >= items_.Size())
+			return NO_ITEM;
+
+		unsigned indent = items_[index].indent_;
+		while (index-- > 0)
+		{
+			if (items_[index].indent_ < indent)
+				return index;
+		}
+
+		return NO_ITEM;
+	}
+
+	unsigned HierarchyList::GetChildrenEnd(unsigned index) const
+	{
+		if (index >= items_.Size())
+			return items_.Size();
+
+		unsigned indent = items_[index].indent_;
+		unsigned end = index + 1;
+		while (end < items_.Size() && items_[end].indent_ > indent)
+			++end;
+		return end;
+	}
+
+	bool HierarchyList::HasChildren(unsigned index) const
+	{
+		if (index >= items_.Size())
+			return false;
+		if (!items_[index].populated_ && items_[index].hasChildren_)
+			return true;
+		return index + 1 < items_.Size() && items_[index + 1].indent_ > items_[index].indent_;
+	}
+
+	void HierarchyList::UpdateVisibleItems()
+	{
+		visibleItems_.Clear();
+
+		unsigned numItems = items_.Size();
+		if (filtered_)
+		{
+			// Mark the parents of each matched item, up to the first one already marked
+			PODVector<unsigned char> shown(numItems);
+			PODVector<unsigned> parents;
+			for (unsigned i = 0; i < numItems; ++i)
+			{
+				shown[i] = items_[i].matched_;
+				parents.Resize(Min((unsigned)items_[i].indent_, parents.Size()));
+				if (shown[i])
+				{
+					for (unsigned j = parents.Size(); j-- > 0 && !shown[parents[j]];)
+						shown[parents[j]] = 1;
+				}
+				parents.Push(i);
+			}
+
+			for (unsigned i = 0; i < numItems; ++i)
+			{
+				if (shown[i])
+					visibleItems_.Push(i);
+			}
+		}
+		else
+		{
+			for (unsigned i = 0; i < numItems;)
+			{
+				visibleItems_.Push(i);
+				unsigned indent = items_[i].indent_;
+				bool expanded = items_[i].expanded_;
+				++i;
+
+				// Skip the children of collapsed items
+				if (!expanded)
+				{
+					while (i < numItems && items_[i].indent_ > indent)
+						++i;
+				}
+			}
+		}
+
+		visibleDirty_ = false;
+		rowsDirty_ = true;
+		UpdateContentSize();
+	}
+
+	void HierarchyList::UpdateContentSize()
+	{
+		const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+		int width = Max(scrollPanel_->GetWidth() - clipBorder.left_ - clipBorder.right_, 1);
+		int height = Max((int)visibleItems_.Size() * rowHeight_, 1);
+		if (contentElement_->GetSize() == IntVector2(width, height))
+			return;
+
+		contentElement_->SetSize(width, height);
+		// Rows span the view so that the selection highlight does
+		for (unsigned i = 0; i < rows_.Size(); ++i)
+			rows_[i]->SetMinWidth(width);
+	}
+
+	void HierarchyList::UpdateRows()
+	{
+		UpdateContentSize();
+
+		rowsViewPosition_ = viewPosition_;
+		rowsViewSize_ = scrollPanel_->GetSize();
+		rowsDirty_ = false;
+
+		const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+		int viewHeight = Max(rowsViewSize_.y_ - clipBorder.top_ - clipBorder.bottom_, 0);
+		unsigned first = (unsigned)(Max(viewPosition_.y_, 0) / rowHeight_);
+		// Two more for the partly visible rows at the edges
+		unsigned numRows = (unsigned)(viewHeight / rowHeight_) + 2;
+
+		while (rows_.Size() < numRows)
+		{
+			Text* row = contentElement_->CreateChild<Text>();
+			row->SetInternal(true);
+			row->SetStyle("FileSelectorListText");
+			// Enable input so that clicks on the row are detected
+			row->SetEnabled(true);
+			row->SetFixedHeight(rowHeight_);
+			row->SetMinWidth(contentElement_->GetWidth());
+			row->SetVar(ROW_INDEX_VAR, rows_.Size());
+
+			BorderImage* icon = row->CreateChild<BorderImage>("Icon");
+			icon->SetInternal(true);
+			icon->SetFixedSize(row->GetIndentSpacing() - 2, 14);
+
+			CheckBox* toggle = row->CreateChild<CheckBox>("Toggle");
+			toggle->SetInternal(true);
+			toggle->SetStyle("HierarchyListViewOverlay");
+			toggle->SetVar(ROW_INDEX_VAR, rows_.Size());
+			SubscribeToEvent(toggle, E_TOGGLED, HANDLER(HierarchyList, HandleToggled));
+
+			rows_.Push(SharedPtr<Text>(row));
+			rowItems_.Push(NO_ITEM);
+			rowIcons_.Push(M_MAX_UNSIGNED);
+		}
+
+		for (unsigned i = 0; i < rows_.Size(); ++i)
+		{
+			unsigned position = first + i;
+			if (i < numRows && position < visibleItems_.Size())
+			{
+				BindRow(i, visibleItems_[position]);
+				rows_[i]->SetPosition(0, (int)position * rowHeight_);
+				rows_[i]->SetVisible(true);
+			}
+			else
+			{
+				rowItems_[i] = NO_ITEM;
+				rows_[i]->SetVisible(false);
+			}
+		}
+	}
+
+	void HierarchyList::BindRow(unsigned rowIndex, unsigned index)
+	{
+		Text* row = rows_[rowIndex];
+		const HierarchyListItem& item = items_[index];
+		rowItems_[rowIndex] = index;
+
+		// The expand toggle and the icon take the two indent levels before the text
+		int indentSpacing = row->GetIndentSpacing();
+		row->SetIndent(item.indent_ + 2);
+		row->SetText(titles_[item.title_]);
+		row->SetColor(itemColors_[item.type_]);
+		row->SetSelected(item.selected_);
+		row->SetDragDropMode(item.dragDropMode_);
+		row->SetVar(TYPE_VAR, item.type_);
+		row->SetVar(ID_VARS[item.type_], item.id_);
+		// Node ID as drag and drop content for node ID editing, components carry their node's ID
+		if (item.type_ == ITEM_NODE)
+		{
+			row->SetVar(NODE_ID_VAR, item.id_);
+			row->SetVar(DRAGDROPCONTENT_VAR, String(item.id_));
+		}
+		else if (item.type_ == ITEM_COMPONENT)
+		{
+			unsigned parentIndex = GetParentItem(index);
+			if (parentIndex != NO_ITEM)
+				row->SetVar(NODE_ID_VAR, items_[parentIndex].id_);
+		}
+
+		BorderImage* icon = static_cast<BorderImage*>(row->GetChild(String("Icon")));
+		icon->SetVisible(iconStyle_.NotNull());
+		if (iconStyle_ && rowIcons_[rowIndex] != item.icon_)
+		{
+			if (!icon->SetStyle(iconTypes_[item.icon_], iconStyle_))
+				icon->SetStyle("Unknown", iconStyle_);
+			rowIcons_[rowIndex] = item.icon_;
+		}
+		icon->SetPosition((item.indent_ + 1) * indentSpacing, 1);
+		UIUtils::SetIconEnabledColor(row, item.enabled_);
+
+		CheckBox* toggle = static_cast<CheckBox*>(row->GetChild(String("Toggle")));
+		toggle->SetVisible(HasChildren(index));
+		toggle->SetChecked(item.expanded_);
+		toggle->SetPosition(item.indent_ * indentSpacing, 0);
+	}
+
+	unsigned HierarchyList::Populate(unsigned index)
+	{
+		if (index >= items_.Size() || items_[index].populated_)
+			return 0;
+
+		items_[index].populated_ = true;
+		items_[index].hasChildren_ = false;
+
+		using namespace HierarchyListPopulate;
+
+		unsigned numItems = items_.Size();
+		VariantMap& eventData = GetEventDataMap();
+		eventData[P_ELEMENT] = this;
+		eventData[P_INDEX] = index;
+		SendEvent(E_HIERARCHYLISTPOPULATE, eventData);
+
+		return items_.Size() - numItems;
+	}
+
+	void HierarchyList::UpdateIndex()
+	{
+		unsigned numItems = items_.Size();
+		for (unsigned i = firstStaleIndex_; i < numItems; ++i)
+		{
+			const HierarchyListItem& item = items_[i];
+			if (item.type_ > ITEM_NONE && item.type_ <= ITEM_UI_ELEMENT)
+				index_[item.type_][item.id_] = i;
+		}
+
+		firstStaleIndex_ = numItems;
+	}
+
+	unsigned HierarchyList::GetVisiblePosition(unsigned index)
+	{
+		if (visibleDirty_)
+			UpdateVisibleItems();
+
+		// Visible items are in ascending order
+		unsigned left = 0;
+		unsigned right = visibleItems_.Size();
+		while (left < right)
+		{
+			unsigned middle = (left + right) / 2;
+			if (visibleItems_[middle] < index)
+				left = middle + 1;
+			else
+				right = middle;
+		}
+
+		return left < visibleItems_.Size() && visibleItems_[left] == index ? left : NO_ITEM;
+	}
+
+	unsigned HierarchyList::GetVisibleNeighbour(unsigned index, int offset)
+	{
+		unsigned position = GetVisiblePosition(index);
+		if (position == NO_ITEM)
+			return NO_ITEM;
+
+		int neighbour = Clamp((int)position + offset, 0, (int)visibleItems_.Size() - 1);
+		return visibleItems_[neighbour];
+	}
+
+	void HierarchyList::SendSelectionChanged()
+	{
+		using namespace SelectionChanged;
+
+		VariantMap& eventData = GetEventDataMap();
+		eventData[P_ELEMENT] = this;
+		SendEvent(E_SELECTIONCHANGED, eventData);
+	}
+
+	void HierarchyList::HandleUIMouseClick(StringHash eventType, VariantMap& eventData)
+	{
+		// Click and click end carry the same parameters
+		using namespace UIMouseClick;
+
+		if ((eventType == E_UIMOUSECLICKEND) != selectOnClickEnd_)
+			return;
+		// A drag that ended on a row does not select it
+		if (eventType == E_UIMOUSECLICKEND && eventData[UIMouseClickEnd::P_BEGINELEMENT].GetPtr() != eventData[P_ELEMENT].GetPtr())
+			return;
+
+		UIElement* row = static_cast<UIElement*>(eventData[P_ELEMENT].GetPtr());
+		while (row != NULL && row->GetParent() != contentElement_)
+		{
+			// The expand toggle is handled by its toggled event
+			if (row->GetType() == CheckBox::GetTypeStatic())
+				return;
+			row = row->GetParent();
+		}
+		if (row == NULL || eventData[P_BUTTON].GetInt() != MOUSEB_LEFT)
+			return;
+
+		unsigned rowIndex = row->GetVar(ROW_INDEX_VAR).GetUInt();
+		if (rowIndex >= rowItems_.Size() || rowItems_[rowIndex] >= items_.Size())
+			return;
+		unsigned index = rowItems_[rowIndex];
+
+		int qualifiers = eventData[P_QUALIFIERS].GetInt();
+		if ((qualifiers & QUAL_SHIFT) && !selections_.Empty())
+		{
+			// Add the visible items between the last selected one and this one
+			unsigned from = GetVisiblePosition(selections_.Back());
+			unsigned to = GetVisiblePosition(index);
+			if (from != NO_ITEM && to != NO_ITEM)
+			{
+				PODVector<unsigned> indices = selections_;
+				for (unsigned i = Min(from, to); i <= Max(from, to); ++i)
+					indices.Push(visibleItems_[i]);
+				SetSelections(indices);
+			}
+		}
+		else if (qualifiers & QUAL_CTRL)
+			ToggleSelection(index);
+		else
+			SetSelection(index);
+
+		if (doubleClickTimer_ > 0.0f && lastClickedItem_ == index)
+		{
+			doubleClickTimer_ = 0.0f;
+
+			VariantMap& newEventData = GetEventDataMap();
+			newEventData[ItemDoubleClicked::P_ELEMENT] = this;
+			newEventData[ItemDoubleClicked::P_ITEM] = row;
+			newEventData[ItemDoubleClicked::P_BUTTON] = MOUSEB_LEFT;
+			SendEvent(E_ITEMDOUBLECLICKED, newEventData);
+		}
+		else
+		{
+			doubleClickTimer_ = DOUBLECLICK_INTERVAL;
+			lastClickedItem_ = index;
+		}
+	}
+
+	void HierarchyList::HandleToggled(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace Toggled;
+
+		UIElement* toggle = static_cast<UIElement*>(eventData[P_ELEMENT].GetPtr());
+		unsigned rowIndex = toggle->GetVar(ROW_INDEX_VAR).GetUInt();
+		if (rowIndex >= rowItems_.Size())
+			return;
+
+		// Binding a row sets the state the item already has
+		unsigned index = rowItems_[rowIndex];
+		bool state = eventData[P_STATE].GetBool();
+		if (index < items_.Size() && items_[index].expanded_ != state)
+			Expand(index, state);
+	}
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "../UI/ScrollView.h"
+#include "../Container/HashMap.h"
+#include "UIGlobals.h"
+
+namespace Urho3D
+{
+	class BorderImage;
+	class CheckBox;
+	class Text;
+	class XMLFile;
+
+	/// Hierarchy list item expanded for the first time, its child items should be inserted now.
+	EVENT(E_HIERARCHYLISTPOPULATE, HierarchyListPopulate)
+	{
+		PARAM(P_ELEMENT, Element);            // UIElement pointer
+		PARAM(P_INDEX, Index);                // unsigned
+	}
+
+	/// Hierarchy list model item. Kept small and plain so that large scenes stay a compact array.
+	struct HierarchyListItem
+	{
+		/// Construct.
+		HierarchyListItem() :
+			type_(ITEM_NONE),
+			id_(0),
+			indent_(0),
+			icon_(0),
+			title_(0),
+			dragDropMode_(DD_DISABLED),
+			enabled_(true),
+			expanded_(true),
+			selected_(false),
+			populated_(true),
+			hasChildren_(false),
+			matched_(false)
+		{
+		}
+
+		/// Item type, ITEM_NODE, ITEM_COMPONENT or ITEM_UI_ELEMENT.
+		int type_;
+		/// Node, component or UI element ID.
+		unsigned id_;
+		/// Depth below the root level. Set by the list.
+		unsigned short indent_;
+		/// Icon type index. Set by the list.
+		unsigned short icon_;
+		/// Title slot, titles stay in place when items move. Set by the list.
+		unsigned title_;
+		/// Drag and drop mode of the row.
+		unsigned char dragDropMode_;
+		/// Icon shown enabled.
+		bool enabled_;
+		/// Child items shown.
+		bool expanded_;
+		/// Selected. Set by the list.
+		bool selected_;
+		/// Child items inserted. When not, E_HIERARCHYLISTPOPULATE is sent on the first expand.
+		bool populated_;
+		/// Child items exist before they are inserted, shows the expand toggle.
+		bool hasChildren_;
+		/// Matches the filter. Set by the list.
+		bool matched_;
+	};
+
+	/// Virtualized hierarchy list. Items live in a flat array in display order, Text rows are created only for the visible part of the scroll view and rebound as it scrolls.
+	class HierarchyList : public ScrollView
+	{
+		OBJECT(HierarchyList);
+	public:
+		/// Construct.
+		HierarchyList(Context* context);
+		/// Destruct.
+		virtual ~HierarchyList();
+		/// Register object factory.
+		static void RegisterObject(Context* context);
+
+		/// Rebind the rows when the view or the items changed.
+		virtual void Update(float timeStep);
+		/// Move the selection with the arrow keys, collapse and expand with left and right.
+		virtual void OnKey(int key, int buttons, int qualifiers);
+
+		/// Insert an item as a child of parentIndex, or at the root level with NO_ITEM. The index is kept after the parent but not checked against its other children, see GetChildrenEnd(). Return the index inserted at.
+		unsigned InsertItem(unsigned index, unsigned parentIndex, const HierarchyListItem& item, const String& title, const String& iconType);
+		/// Remove an item with its child items.
+		void RemoveItem(unsigned index);
+		/// Remove all items.
+		void RemoveAllItems();
+		/// Set item title.
+		void SetItemTitle(unsigned index, const String& title);
+		/// Set whether the item's icon is shown enabled.
+		void SetItemEnabled(unsigned index, bool enable);
+		/// Set text color of an item type.
+		void SetItemColor(int type, const Color& color);
+		/// Set the style file of the item icons.
+		void SetIconStyle(XMLFile* iconStyle);
+		/// Set row height in pixels.
+		void SetRowHeight(int height);
+		/// Set whether selection happens on click end, so that items can be dragged without changing the selection.
+		void SetSelectOnClickEnd(bool enable);
+
+		/// Set the only selected item.
+		void SetSelection(unsigned index);
+		/// Set the selected items.
+		void SetSelections(const PODVector<unsigned>& indices);
+		/// Add an item to the selection.
+		void AddSelection(unsigned index);
+		/// Remove an item from the selection.
+		void RemoveSelection(unsigned index);
+		/// Add or remove an item from the selection.
+		void ToggleSelection(unsigned index);
+		/// Clear the selection.
+		void ClearSelection();
+		/// Set whether an item not yet populated has child items.
+		void SetItemHasChildren(unsigned index, bool enable);
+		/// Show or hide the child items of an item. Expanding populates the items.
+		void Expand(unsigned index, bool enable, bool recursive = false);
+		/// Toggle the child items of an item.
+		void ToggleExpand(unsigned index, bool recursive = false);
+		/// Scroll the view to show an item. Its parents must be expanded.
+		void EnsureItemVisibility(unsigned index);
+		/// Show only the given items and their parents, regardless of the expanded state.
+		void SetFilter(const PODVector<unsigned>& indices);
+		/// Show all items again.
+		void ClearFilter();
+		/// Send E_HIERARCHYLISTPOPULATE for an item not yet populated. Return number of items inserted.
+		unsigned Populate(unsigned index);
+
+		/// Return number of items.
+		unsigned GetNumItems() const { return items_.Size(); }
+		/// Return number of items with all their parents expanded.
+		unsigned GetNumVisibleItems();
+		/// Return item.
+		const HierarchyListItem& GetItem(unsigned index) const { return items_[index]; }
+		/// Return item title.
+		const String& GetItemTitle(unsigned index) const { return titles_[items_[index].title_]; }
+		/// Return index of an item by type and ID, or NO_ITEM.
+		unsigned FindItem(int type, unsigned id);
+		/// Return index of the item's parent, or NO_ITEM at the root level.
+		unsigned GetParentItem(unsigned index) const;
+		/// Return the index after the item's last child item.
+		unsigned GetChildrenEnd(unsigned index) const;
+		/// Return whether the item has child items, inserted or not.
+		bool HasChildren(unsigned index) const;
+		/// Return whether the item's child items have been inserted.
+		bool IsPopulated(unsigned index) const { return index < items_.Size() && items_[index].populated_; }
+		/// Return whether the item's child items are shown.
+		bool IsExpanded(unsigned index) const { return index < items_.Size() && items_[index].expanded_; }
+		/// Return selected items in selection order.
+		const PODVector<unsigned>& GetSelections() const { return selections_; }
+		/// Return the first selected item, or NO_ITEM.
+		unsigned GetSelection() const { return selections_.Empty() ? NO_ITEM : selections_[0]; }
+		/// Return whether the items are filtered.
+		bool IsFiltered() const { return filtered_; }
+		/// Return whether an item is selected.
+		bool IsSelected(unsigned index) const { return index < items_.Size() && items_[index].selected_; }
+		/// Return row height.
+		int GetRowHeight() const { return rowHeight_; }
+		/// Return number of row elements created.
+		unsigned GetNumRows() const { return rows_.Size(); }
+
+	protected:
+		/// Rebuild the visible item list and resize the content element.
+		void UpdateVisibleItems();
+		/// Size the content element to the visible items and the panel width.
+		void UpdateContentSize();
+		/// Create rows for the visible part of the view and bind them to their items.
+		void UpdateRows();
+		/// Bind a row to an item.
+		void BindRow(unsigned rowIndex, unsigned index);
+		/// Refresh the stale rows of the index.
+		void UpdateIndex();
+		/// Return position of an item in the visible items, or NO_ITEM.
+		unsigned GetVisiblePosition(unsigned index);
+		/// Return the visible item before or after an item.
+		unsigned GetVisibleNeighbour(unsigned index, int offset);
+		/// Send the selection changed event.
+		void SendSelectionChanged();
+		/// Handle clicks on the rows.
+		void HandleUIMouseClick(StringHash eventType, VariantMap& eventData);
+		/// Handle the expand toggle of a row.
+		void HandleToggled(StringHash eventType, VariantMap& eventData);
+
+		/// Items in display order.
+		PODVector<HierarchyListItem> items_;
+		/// Item titles by slot.
+		Vector<String> titles_;
+		/// Unused title slots.
+		PODVector<unsigned> freeTitles_;
+		/// Indices of the items with all their parents expanded.
+		PODVector<unsigned> visibleItems_;
+		/// Selected items.
+		PODVector<unsigned> selections_;
+		/// Item indices by ID, per item type.
+		HashMap<unsigned, unsigned> index_[ITEM_UI_ELEMENT + 1];
+		/// Indices from this one on are stale in the index. Inserts and removals lower it to the first item they move, items before it are always indexed right.
+		unsigned firstStaleIndex_;
+		/// Icon type names.
+		Vector<String> iconTypes_;
+		/// Icon type name indices.
+		HashMap<StringHash, unsigned> iconTypeIndices_;
+		/// Icon style file.
+		SharedPtr<XMLFile> iconStyle_;
+		/// Text color per item type.
+		Color itemColors_[ITEM_UI_ELEMENT + 1];
+
+		/// Row elements.
+		Vector<SharedPtr<Text> > rows_;
+		/// Item bound to each row.
+		PODVector<unsigned> rowItems_;
+		/// Icon type shown by each row.
+		PODVector<unsigned> rowIcons_;
+		/// Row height.
+		int rowHeight_;
+		/// View position and size the rows were bound for.
+		IntVector2 rowsViewPosition_;
+		IntVector2 rowsViewSize_;
+		/// Visible items need rebuilding.
+		bool visibleDirty_;
+		/// Rows need rebinding.
+		bool rowsDirty_;
+		/// Select on click end instead of click.
+		bool selectOnClickEnd_;
+		/// Only matched items and their parents are visible.
+		bool filtered_;
+		/// Double click detection.
+		float doubleClickTimer_;
+		unsigned lastClickedItem_;
+	};
+}
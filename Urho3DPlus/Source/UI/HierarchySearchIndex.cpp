@@ -0,0 +1,212 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "HierarchySearchIndex.h"
+#include "../Container/Sort.h"
+#include "../Scene/Component.h"
+#include "../Scene/Node.h"
+#include "../Scene/Scene.h"
+
+namespace Urho3D
+{
+	/// Pack three lowercase name bytes into a trigram key.
+	static unsigned GetTrigram(const String& str, unsigned index)
+	{
+		return ((unsigned)(unsigned char)str[index] << 16) | ((unsigned)(unsigned char)str[index + 1] << 8) | (unsigned)(unsigned char)str[index + 2];
+	}
+
+	/// Smaller trigram node set first.
+	static bool CompareSetSizes(const HashSet<unsigned>* lhs, const HashSet<unsigned>* rhs)
+	{
+		return lhs->Size() < rhs->Size();
+	}
+
+	HierarchySearchIndex::HierarchySearchIndex()
+	{
+	}
+
+	void HierarchySearchIndex::Build(Scene* scene)
+	{
+		Clear();
+		if (scene)
+			AddNode(scene);
+	}
+
+	void HierarchySearchIndex::Clear()
+	{
+		names_.Clear();
+		trigrams_.Clear();
+		componentTypes_.Clear();
+		typeNames_.Clear();
+		components_.Clear();
+	}
+
+	void HierarchySearchIndex::AddNode(Node* node)
+	{
+		AddName(node->GetID(), node->GetName());
+
+		const Vector<SharedPtr<Component> >& components = node->GetComponents();
+		for (unsigned i = 0; i < components.Size(); ++i)
+			AddComponent(components[i]);
+
+		const Vector<SharedPtr<Node> >& children = node->GetChildren();
+		for (unsigned i = 0; i < children.Size(); ++i)
+			AddNode(children[i]);
+	}
+
+	void HierarchySearchIndex::RemoveNode(Node* node)
+	{
+		RemoveName(node->GetID());
+
+		const Vector<SharedPtr<Component> >& components = node->GetComponents();
+		for (unsigned i = 0; i < components.Size(); ++i)
+			RemoveComponent(components[i]);
+
+		const Vector<SharedPtr<Node> >& children = node->GetChildren();
+		for (unsigned i = 0; i < children.Size(); ++i)
+			RemoveNode(children[i]);
+	}
+
+	void HierarchySearchIndex::UpdateNodeName(Node* node)
+	{
+		AddName(node->GetID(), node->GetName());
+	}
+
+	void HierarchySearchIndex::AddComponent(Component* component)
+	{
+		Node* node = component->GetNode();
+		if (node == NULL || components_.Contains(component->GetID()))
+			return;
+
+		StringHash type = component->GetType();
+		components_[component->GetID()] = MakePair(node->GetID(), type);
+		++componentTypes_[type][node->GetID()];
+		if (!typeNames_.Contains(type))
+			typeNames_[type] = component->GetTypeName().ToLower();
+	}
+
+	void HierarchySearchIndex::RemoveComponent(Component* component)
+	{
+		HashMap<unsigned, Pair<unsigned, StringHash> >::Iterator i = components_.Find(component->GetID());
+		if (i == components_.End())
+			return;
+
+		HashMap<unsigned, unsigned>& nodes = componentTypes_[i->second_.second_];
+		HashMap<unsigned, unsigned>::Iterator j = nodes.Find(i->second_.first_);
+		if (j != nodes.End() && --j->second_ == 0)
+			nodes.Erase(j);
+		components_.Erase(i);
+	}
+
+	void HierarchySearchIndex::Query(const String& query, PODVector<unsigned>& nodeIDs) const
+	{
+		nodeIDs.Clear();
+		String str = query.Trimmed().ToLower();
+		if (str.Empty())
+			return;
+
+		if (str.Length() >= 3)
+		{
+			// A name containing the query contains all of its trigrams, any missing one means no name matches
+			PODVector<const HashSet<unsigned>*> sets;
+			for (unsigned i = 0; i + 3 <= str.Length(); ++i)
+			{
+				HashMap<unsigned, HashSet<unsigned> >::ConstIterator trigram = trigrams_.Find(GetTrigram(str, i));
+				if (trigram == trigrams_.End())
+				{
+					sets.Clear();
+					break;
+				}
+				sets.Push(&trigram->second_);
+			}
+
+			if (!sets.Empty())
+			{
+				// Intersect from the smallest set, so each further set rules out candidates as early as possible
+				Sort(sets.Begin(), sets.End(), CompareSetSizes);
+				for (HashSet<unsigned>::ConstIterator i = sets[0]->Begin(); i != sets[0]->End(); ++i)
+				{
+					unsigned j = 1;
+					while (j < sets.Size() && sets[j]->Contains(*i))
+						++j;
+					if (j < sets.Size())
+						continue;
+
+					// The trigrams may be in another order, check the whole name
+					HashMap<unsigned, String>::ConstIterator name = names_.Find(*i);
+					if (name != names_.End() && name->second_.Contains(str))
+						nodeIDs.Push(*i);
+				}
+			}
+		}
+		else
+		{
+			// Too short for a trigram
+			for (HashMap<unsigned, String>::ConstIterator i = names_.Begin(); i != names_.End(); ++i)
+			{
+				if (i->second_.Contains(str))
+					nodeIDs.Push(i->first_);
+			}
+		}
+
+		HashSet<unsigned> found;
+		for (HashMap<StringHash, String>::ConstIterator i = typeNames_.Begin(); i != typeNames_.End(); ++i)
+		{
+			if (!i->second_.Contains(str))
+				continue;
+
+			HashMap<StringHash, HashMap<unsigned, unsigned> >::ConstIterator type = componentTypes_.Find(i->first_);
+			if (type == componentTypes_.End() || type->second_.Empty())
+				continue;
+
+			// Name matches are only collected for deduplication when a type matches too
+			if (found.Empty())
+			{
+				for (unsigned j = 0; j < nodeIDs.Size(); ++j)
+					found.Insert(nodeIDs[j]);
+			}
+			for (HashMap<unsigned, unsigned>::ConstIterator j = type->second_.Begin(); j != type->second_.End(); ++j)
+			{
+				if (!found.Contains(j->first_))
+				{
+					found.Insert(j->first_);
+					nodeIDs.Push(j->first_);
+				}
+			}
+		}
+	}
+
+	void HierarchySearchIndex::AddName(unsigned nodeID, const String& name)
+	{
+		String str = name.ToLower();
+		HashMap<unsigned, String>::Iterator i = names_.Find(nodeID);
+		if (i != names_.End())
+		{
+			if (i->second_ == str)
+				return;
+			RemoveName(nodeID);
+		}
+
+		names_[nodeID] = str;
+		for (unsigned j = 0; j + 3 <= str.Length(); ++j)
+			trigrams_[GetTrigram(str, j)].Insert(nodeID);
+	}
+
+	void HierarchySearchIndex::RemoveName(unsigned nodeID)
+	{
+		HashMap<unsigned, String>::Iterator i = names_.Find(nodeID);
+		if (i == names_.End())
+			return;
+
+		const String& str = i->second_;
+		for (unsigned j = 0; j + 3 <= str.Length(); ++j)
+		{
+			HashMap<unsigned, HashSet<unsigned> >::Iterator trigram = trigrams_.Find(GetTrigram(str, j));
+			if (trigram == trigrams_.End())
+				continue;
+			trigram->second_.Erase(nodeID);
+			if (trigram->second_.Empty())
+				trigrams_.Erase(trigram);
+		}
+		names_.Erase(i);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+#include "../Container/Str.h"
+#include "../Math/StringHash.h"
+
+namespace Urho3D
+{
+	class Component;
+	class Node;
+	class Scene;
+
+	/// Scene node search index. Node names are indexed by trigram and nodes by component type, both kept up to date from the scene events.
+	class HierarchySearchIndex
+	{
+	public:
+		/// Construct.
+		HierarchySearchIndex();
+
+		/// Index all nodes and components of a scene.
+		void Build(Scene* scene);
+		/// Remove all nodes.
+		void Clear();
+		/// Add a node with its components and child nodes.
+		void AddNode(Node* node);
+		/// Remove a node with its components and child nodes.
+		void RemoveNode(Node* node);
+		/// Index the node's current name.
+		void UpdateNodeName(Node* node);
+		/// Add a component to its node's types.
+		void AddComponent(Component* component);
+		/// Remove a component from its node's types.
+		void RemoveComponent(Component* component);
+
+		/// Return IDs of the nodes whose name or one of whose component type names contains the query, case insensitive.
+		void Query(const String& query, PODVector<unsigned>& nodeIDs) const;
+		/// Return number of indexed nodes.
+		unsigned GetNumNodes() const { return names_.Size(); }
+
+	private:
+		/// Add a node name to the trigrams.
+		void AddName(unsigned nodeID, const String& name);
+		/// Remove a node name from the trigrams.
+		void RemoveName(unsigned nodeID);
+
+		/// Lowercase node names by node ID.
+		HashMap<unsigned, String> names_;
+		/// Node IDs by name trigram.
+		HashMap<unsigned, HashSet<unsigned> > trigrams_;
+		/// Component count per node ID by component type.
+		HashMap<StringHash, HashMap<unsigned, unsigned> > componentTypes_;
+		/// Lowercase component type names.
+		HashMap<StringHash, String> typeNames_;
+		/// Node ID and type of each indexed component by component ID.
+		HashMap<unsigned, Pair<unsigned, StringHash> > components_;
+	};
+}
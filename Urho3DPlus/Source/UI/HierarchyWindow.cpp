@@ -1,18 +1,46 @@
 #include "HierarchyWindow.h"
 #include "..\UI\Text.h"
 #include "..\UI\Button.h"
-#include "..\UI\ListView.h"
+#include "HierarchyList.h"
 #include "..\UI\CheckBox.h"
 #include "..\UI\UIEvents.h"
 #include "..\Scene\SceneEvents.h"
 #include "..\Scene\Node.h"
 #include "..\Scene\Component.h"
 #include "UIUtils.h"
+#include "Utils/StageTimer.h"
 #include "..\Scene\Scene.h"
 #include "..\UI\UIElement.h"
+#include "..\IO\Log.h"
+#include "..\Core\Timer.h"
+#include "..\Container\Sort.h"
+#include "..\Core\CoreEvents.h"
+#include "..\UI\LineEdit.h"
 
 namespace Urho3D
 {
+	/// Search matches shown at most, each one may populate its parent chain.
+	static const unsigned MAX_SEARCH_RESULTS = 1000;
+
+	/// Return the parent node of a node or component, or the parent of a UI element.
+	static Serializable* GetParentSerializable(Serializable* serializable)
+	{
+		switch (UIUtils::GetType(serializable))
+		{
+		case ITEM_NODE:
+			return static_cast<Node*>(serializable)->GetParent();
+
+		case ITEM_COMPONENT:
+			return static_cast<Component*>(serializable)->GetNode();
+
+		case ITEM_UI_ELEMENT:
+			return static_cast<UIElement*>(serializable)->GetParent();
+
+		default:
+			return NULL;
+		}
+	}
+
 	HierarchyWindow::HierarchyWindow(Context* context) : Window(context)
 	{
 		normalTextColor_ = Color(1.0f, 1.0f, 1.0f);
@@ -86,11 +114,13 @@ namespace Urho3D
 		label->SetInternal(true);
 		label->SetText("All");
 
-		hierarchyList_ = CreateChild<ListView>("HW_ListView");
+		searchEdit_ = CreateChild<LineEdit>("HW_SearchEdit");
+		searchEdit_->SetInternal(true);
+		searchEdit_->SetFixedHeight(17);
+
+		hierarchyList_ = CreateChild<HierarchyList>("HW_ListView");
 		hierarchyList_->SetInternal(true);
 		hierarchyList_->SetName("HierarchyList");
-		hierarchyList_->SetHighlightMode(HM_ALWAYS);
-		hierarchyList_->SetMultiselect(true);
 
 		// Set selection to happen on click end, so that we can drag nodes to the inspector without resetting the inspector view
 		hierarchyList_->SetSelectOnClickEnd(true);
@@ -103,12 +133,15 @@ namespace Urho3D
 		SubscribeToEvent(expandButton_, E_RELEASED, HANDLER(HierarchyWindow, ExpandCollapseHierarchy));
 		SubscribeToEvent(collapseButton_, E_RELEASED, HANDLER(HierarchyWindow, ExpandCollapseHierarchy));
 
+		SubscribeToEvent(searchEdit_, E_TEXTCHANGED, HANDLER(HierarchyWindow, HandleSearchTextChanged));
 		SubscribeToEvent(hierarchyList_, E_SELECTIONCHANGED, HANDLER(HierarchyWindow, HandleHierarchyListSelectionChange));
 		SubscribeToEvent(hierarchyList_, E_ITEMDOUBLECLICKED, HANDLER(HierarchyWindow, HandleHierarchyListDoubleClick));
+		SubscribeToEvent(hierarchyList_, E_HIERARCHYLISTPOPULATE, HANDLER(HierarchyWindow, HandleHierarchyListPopulate));
 
 		SubscribeToEvent(E_DRAGDROPTEST, HANDLER(HierarchyWindow, HandleDragDropTest));
 		SubscribeToEvent(E_DRAGDROPFINISH, HANDLER(HierarchyWindow, HandleDragDropFinish));
 		SubscribeToEvent(E_TEMPORARYCHANGED, HANDLER(HierarchyWindow, HandleTemporaryChanged));
+		SubscribeToEvent(E_UPDATE, HANDLER(HierarchyWindow, HandleUpdate));
 	}
 
 	HierarchyWindow::~HierarchyWindow()
@@ -147,8 +180,10 @@ namespace Urho3D
 		bool all = allCheckBox_->IsChecked();
 		allCheckBox_->SetChecked(false);    // Auto-reset
 
-		const PODVector<unsigned int> selections = hierarchyList_->GetSelections();
-		for (unsigned int i = 0; i < selections.Size(); ++i)
+		// Last item first, populating an item moves the items after it
+		PODVector<unsigned int> selections = hierarchyList_->GetSelections();
+		Sort(selections.Begin(), selections.End());
+		for (unsigned int i = selections.Size(); i-- > 0;)
 			hierarchyList_->Expand(selections[i], enable, all);
 	}
 
@@ -166,6 +201,25 @@ namespace Urho3D
 // 		editor_->OnHierarchyListDoubleClick(item);
 	}
 
+	void HierarchyWindow::HandleHierarchyListPopulate(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace HierarchyListPopulate;
+		ScopedStageTimer timer(this, STAGE_HIERARCHY);
+
+		unsigned int index = eventData[P_INDEX].GetUInt();
+		Serializable* serializable = GetListSerializable(index);
+		if (serializable)
+			AddChildItems(index, serializable);
+	}
+
+	void HierarchyWindow::HandleSearchTextChanged(StringHash eventType, VariantMap& eventData)
+	{
+		using namespace TextChanged;
+
+		searchQuery_ = eventData[P_TEXT].GetString();
+		ApplySearch();
+	}
+
 	void HierarchyWindow::HandleDragDropTest(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace DragDropTest;
@@ -232,64 +286,62 @@ namespace Urho3D
 	{
 		using namespace NodeAdded;
 
+		// The search index follows the scene even while the list does not
+		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
+		searchIndex_.AddNode(node);
+
 		if (suppressSceneChanges_)
 			return;
 
-		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
 		if (showTemporaryObject_ || !node->IsTemporary())
-			UpdateHierarchyItem(node);
+			addedNodes_.Insert(node->GetID());
 	}
 
 	void HierarchyWindow::HandleNodeRemoved(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace NodeRemoved;
+		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
+		searchIndex_.RemoveNode(node);
 		if (suppressSceneChanges_)
 			return;
-		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
-		unsigned int index = GetListIndex(node);
-		UpdateHierarchyItem(index, NULL, NULL);
+		// Added and removed within the frame cancels out, the removal then finds no item
+		addedNodes_.Erase(node->GetID());
+		removedNodes_.Insert(node->GetID());
 	}
 
 	void HierarchyWindow::HandleComponentAdded(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace ComponentAdded;
+		Component* component = dynamic_cast<Component*>(eventData[P_COMPONENT].GetPtr());
+		searchIndex_.AddComponent(component);
 		if (suppressSceneChanges_)
 			return;
-		// Insert the newly added component at last component position but before the first child node position of the parent node
-		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
-		Component* component = dynamic_cast<Component*>(eventData[P_COMPONENT].GetPtr());
-
 		if (showTemporaryObject_ || !component->IsTemporary())
-		{
-			unsigned int nodeIndex = GetListIndex(node);
-			if (nodeIndex != NO_ITEM)
-			{
-				unsigned int index = node->GetNumChildren() > 0 ? GetListIndex(node->GetChildren()[0]) : M_MAX_UNSIGNED;
-				UpdateHierarchyItem(index, component, hierarchyList_->GetItems()[nodeIndex]);
-			}
-		}
+			addedComponents_.Insert(component->GetID());
 	}
 
 	void HierarchyWindow::HandleComponentRemoved(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace ComponentRemoved;
+		Component* component = dynamic_cast<Component*>(eventData[P_COMPONENT].GetPtr());
+		searchIndex_.RemoveComponent(component);
 		if (suppressSceneChanges_)
 			return;
-		Component* component = dynamic_cast<Component*>(eventData[P_COMPONENT].GetPtr());
-		unsigned int index = GetComponentListIndex(component);
-		if (index != NO_ITEM)
-			hierarchyList_->RemoveItem(index);
+		addedComponents_.Erase(component->GetID());
+		removedComponents_.Insert(component->GetID());
 	}
 
 	void HierarchyWindow::HandleNodeNameChanged(StringHash eventType, VariantMap& eventData)
 	{
 		using namespace NodeNameChanged;
 
+		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
+		searchIndex_.UpdateNodeName(node);
+
 		if (suppressSceneChanges_)
 			return;
 
-		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
-		UpdateHierarchyItemText(GetListIndex(node), node->IsEnabled(), UIUtils::GetNodeTitle(node));
+		changedNodes_.Insert(node->GetID());
 	}
 
 	void HierarchyWindow::HandleNodeEnabledChanged(StringHash eventType, VariantMap& eventData)
@@ -299,8 +351,7 @@ namespace Urho3D
 			return;
 
 		Node* node = dynamic_cast<Node*>(eventData[P_NODE].GetPtr());
-		UpdateHierarchyItemText(GetListIndex(node), node->IsEnabled());
-
+		changedNodes_.Insert(node->GetID());
 	}
 
 	void HierarchyWindow::HandleComponentEnabledChanged(StringHash eventType, VariantMap& eventData)
@@ -310,8 +361,7 @@ namespace Urho3D
 			return;
 
 		Component* component = dynamic_cast<Component*>(eventData[P_COMPONENT].GetPtr());
-		UpdateHierarchyItemText(GetComponentListIndex(component), component->IsEnabledEffective());
-
+		changedComponents_.Insert(component->GetID());
 	}
 
 	void HierarchyWindow::HandleUIElementNameChanged(StringHash eventType, VariantMap& eventData)
@@ -369,14 +419,13 @@ namespace Urho3D
 
 	void HierarchyWindow::UpdateHierarchyItemText(unsigned int itemIndex, bool iconEnabled, const String& textTitle /*= NO_CHANGE*/)
 	{
-		Text* text = (Text*)hierarchyList_->GetItem(itemIndex);
-		if (text == NULL)
+		if (itemIndex >= hierarchyList_->GetNumItems())
 			return;
 
-		UIUtils::SetIconEnabledColor(text, iconEnabled);
+		hierarchyList_->SetItemEnabled(itemIndex, iconEnabled);
 
 		if (textTitle != NO_CHANGE)
-			text->SetText(textTitle);
+			hierarchyList_->SetItemTitle(itemIndex, textTitle);
 	}
 	void HierarchyWindow::UpdateHierarchyItem(Serializable* serializable, bool clear /*= false*/)
 	{
@@ -391,26 +440,31 @@ namespace Urho3D
 		}
 
 		// In case of item's parent is not found in the hierarchy list then the item will be inserted at the list root level
-		Serializable* parent;
-		switch (UIUtils::GetType(serializable))
+		Serializable* parent = GetParentSerializable(serializable);
+		unsigned int parentIndex = GetListIndex(parent);
+		if (parentIndex != NO_ITEM && !hierarchyList_->IsPopulated(parentIndex))
 		{
-		case ITEM_NODE:
-			parent = static_cast<Node*>(serializable)->GetParent();
-			break;
-
-		case ITEM_COMPONENT:
-			parent = static_cast<Component*>(serializable)->GetNode();
-			break;
-
-		case ITEM_UI_ELEMENT:
-			parent = static_cast<UIElement*>(serializable)->GetParent();
-			break;
-
-		default:
-			break;
+			// Inserted with the other child items when the parent is first expanded
+			hierarchyList_->SetItemHasChildren(parentIndex, true);
+			return;
+		}
+		if (parentIndex == NO_ITEM)
+		{
+			// Below an item not yet populated there is nothing to update
+			for (Serializable* ancestor = GetParentSerializable(parent); ancestor != NULL; ancestor = GetParentSerializable(ancestor))
+			{
+				if (GetListIndex(ancestor) != NO_ITEM)
+					return;
+			}
 		}
-		UIElement* parentItem = hierarchyList_->GetItem(GetListIndex(parent));
-		UpdateHierarchyItem(GetListIndex(serializable), serializable, parentItem);
+
+		unsigned int itemIndex = GetListIndex(serializable);
+		if (itemIndex == NO_ITEM)
+			// New items go after the parent's last child item
+			itemIndex = parentIndex != NO_ITEM ? hierarchyList_->GetChildrenEnd(parentIndex) : hierarchyList_->GetNumItems();
+		hierarchyList_->SetItemColor(ITEM_NODE, nodeTextColor_);
+		hierarchyList_->SetItemColor(ITEM_COMPONENT, componentTextColor_);
+		UpdateHierarchyItem(itemIndex, serializable, parentIndex);
 	}
 
 	void HierarchyWindow::SetTitleBarVisible(bool show)
@@ -429,103 +483,130 @@ namespace Urho3D
 		titleText_->SetText(title);
 	}
 
-	unsigned int HierarchyWindow::UpdateHierarchyItem(unsigned int itemIndex, Serializable* serializable, UIElement* parentItem)
+	unsigned int HierarchyWindow::UpdateHierarchyItem(unsigned int itemIndex, Serializable* serializable, unsigned int parentIndex)
 	{
-		// Whenever we're updating, disable layout update to optimize speed
-		hierarchyList_->GetContentElement()->DisableLayoutUpdate();
-
 		if (serializable == NULL)
 		{
 			hierarchyList_->RemoveItem(itemIndex);
-			hierarchyList_->GetContentElement()->EnableLayoutUpdate();
-			hierarchyList_->GetContentElement()->UpdateLayout();
 			return itemIndex;
 		}
 
 		int itemType = UIUtils::GetType(serializable);
-		Variant id = UIUtils::GetID(serializable, itemType);
+		unsigned int id = UIUtils::GetID(serializable, itemType);
 
-		// Remove old item if exists
-		if (itemIndex < hierarchyList_->GetNumItems() && UIUtils::MatchID(hierarchyList_->GetItem(itemIndex), id, itemType))
-			hierarchyList_->RemoveItem(itemIndex);
+		HierarchyListItem item;
+		item.type_ = itemType;
+		item.id_ = id;
 
-		Text* text = new Text(context_);
-		hierarchyList_->InsertItem(itemIndex, text, parentItem);
-		text->SetStyle("FileSelectorListText");
+		// Only root items get their child items now, the others when first expanded
+		bool populate = parentIndex == NO_ITEM;
+
+		// Remove old item if exists, keeping its expanded state
+		if (itemIndex < hierarchyList_->GetNumItems())
+		{
+			const HierarchyListItem& oldItem = hierarchyList_->GetItem(itemIndex);
+			if (oldItem.type_ == itemType && oldItem.id_ == id)
+			{
+				populate = oldItem.populated_;
+				item.expanded_ = oldItem.expanded_;
+				hierarchyList_->RemoveItem(itemIndex);
+			}
+		}
+
+		if (!populate)
+		{
+			item.populated_ = false;
+			item.expanded_ = false;
+			item.hasChildren_ = HasChildItems(serializable);
+		}
 
 		if (serializable->GetType() == SCENE_TYPE || serializable == mainUI_.Get())
 			// The root node (scene) and editor's root UIElement cannot be moved by drag and drop
-			text->SetDragDropMode(DD_TARGET);
+			item.dragDropMode_ = DD_TARGET;
 		else
 			// Internal UIElement is not able to participate in drag and drop action
-			text->SetDragDropMode(itemType == ITEM_UI_ELEMENT && static_cast<UIElement*>(serializable)->IsInternal() ? DD_DISABLED : DD_SOURCE_AND_TARGET);
-
-		// Advance the index for the child items
-		if (itemIndex == M_MAX_UNSIGNED)
-			itemIndex = hierarchyList_->GetNumItems();
-		else
-			++itemIndex;
+			item.dragDropMode_ = itemType == ITEM_UI_ELEMENT && static_cast<UIElement*>(serializable)->IsInternal() ? DD_DISABLED : DD_SOURCE_AND_TARGET;
 
 		String iconType = serializable->GetTypeName();
 		if (serializable == mainUI_.Get())
 			iconType = "Root" + iconType;
 
-		if (iconStyle_)
-			UIUtils::IconizeUIElement(context_, iconStyle_,text, iconType);
-		
-
-		SetID(text, serializable, itemType);
+		String title;
 		switch (itemType)
 		{
+		case ITEM_NODE:
+			item.enabled_ = static_cast<Node*>(serializable)->IsEnabled();
+			title = UIUtils::GetNodeTitle(static_cast<Node*>(serializable));
+			break;
+
+		case ITEM_COMPONENT:
+			item.enabled_ = static_cast<Component*>(serializable)->IsEnabledEffective();
+			title = UIUtils::GetComponentTitle(static_cast<Component*>(serializable));
+			break;
+
+		case ITEM_UI_ELEMENT:
+			item.enabled_ = static_cast<UIElement*>(serializable)->IsVisible();
+			title = UIUtils::GetUIElementTitle(static_cast<UIElement*>(serializable));
+
+			// Subscribe to UI-element events
+			SubscribeToEvent(serializable, E_NAMECHANGED, HANDLER(HierarchyWindow, HandleUIElementNameChanged));
+			SubscribeToEvent(serializable, E_VISIBLECHANGED, HANDLER(HierarchyWindow, HandleUIElementVisibilityChanged));
+			SubscribeToEvent(serializable, E_RESIZED, HANDLER(HierarchyWindow, HandleUIElementAttributeChanged));
+			SubscribeToEvent(serializable, E_POSITIONED, HANDLER(HierarchyWindow, HandleUIElementAttributeChanged));
+			break;
+
+		default:
+			break;
+		}
+
+		unsigned int row = hierarchyList_->InsertItem(itemIndex, parentIndex, item, title, iconType);
+
+		// Advance the index for the next items
+		return populate ? AddChildItems(row, serializable) : row + 1;
+	}
+
+	unsigned int HierarchyWindow::AddChildItems(unsigned int parentIndex, Serializable* serializable)
+	{
+		unsigned int itemIndex = parentIndex + 1;
+
+		switch (UIUtils::GetType(serializable))
+		{
 		case ITEM_NODE:
 		{
 			Node* node = static_cast<Node*>(serializable);
 
-			text->SetText(UIUtils::GetNodeTitle(node));
-			text->SetColor(nodeTextColor_);
-			UIUtils::SetIconEnabledColor(text, node->IsEnabled());
-
 			// Update components first
-			for (unsigned int i = 0; i < node->GetNumComponents(); ++i)
+			const Vector<SharedPtr<Component> >& components = node->GetComponents();
+			for (unsigned int i = 0; i < components.Size(); ++i)
 			{
-				Component* component = node->GetComponents()[i];
+				Component* component = components[i];
 				if (showTemporaryObject_ || !component->IsTemporary())
-					AddComponentItem(itemIndex++, component, text);
+					itemIndex = AddComponentItem(itemIndex, component, parentIndex);
 			}
 
 			// Then update child nodes recursively
-			for (unsigned int i = 0; i < node->GetNumChildren(); ++i)
+			const Vector<SharedPtr<Node> >& children = node->GetChildren();
+			for (unsigned int i = 0; i < children.Size(); ++i)
 			{
-				Node* childNode = node->GetChildren()[i];
+				Node* childNode = children[i];
 				if (showTemporaryObject_ || !childNode->IsTemporary())
-					itemIndex = UpdateHierarchyItem(itemIndex, childNode, text);
+					itemIndex = UpdateHierarchyItem(itemIndex, childNode, parentIndex);
 			}
 
 			break;
 		}
 
-		case ITEM_COMPONENT:
-		{
-			Component* component = static_cast<Component*>(serializable);
-			text->SetText(UIUtils::GetComponentTitle(component));
-			text->SetColor(componentTextColor_);
-			UIUtils::SetIconEnabledColor(text, component->IsEnabledEffective());
-			break;
-		}
-
 		case ITEM_UI_ELEMENT:
 		{
 			UIElement* element = static_cast<UIElement*>(serializable);
 
-			text->SetText(UIUtils::GetUIElementTitle(element));
-			UIUtils::SetIconEnabledColor(text, element->IsVisible());
-
 			// Update child elements recursively
-			for (unsigned int i = 0; i < element->GetNumChildren(); ++i)
+			const Vector<SharedPtr<UIElement> >& children = element->GetChildren();
+			for (unsigned int i = 0; i < children.Size(); ++i)
 			{
-				UIElement* childElement = element->GetChildren()[i];
+				UIElement* childElement = children[i];
 				if ((showInternalUIElement_ || !childElement->IsInternal()) && (showTemporaryObject_ || !childElement->IsTemporary()))
-					itemIndex = UpdateHierarchyItem(itemIndex, childElement, text);
+					itemIndex = UpdateHierarchyItem(itemIndex, childElement, parentIndex);
 			}
 
 			break;
@@ -535,15 +616,119 @@ namespace Urho3D
 			break;
 		}
 
-		// Re-enable layout update (and do manual layout) now
-		hierarchyList_->GetContentElement()->EnableLayoutUpdate();
-		hierarchyList_->GetContentElement()->UpdateLayout();
-
 		return itemIndex;
 	}
 
+	bool HierarchyWindow::HasChildItems(Serializable* serializable)
+	{
+		switch (UIUtils::GetType(serializable))
+		{
+		case ITEM_NODE:
+		{
+			Node* node = static_cast<Node*>(serializable);
+			const Vector<SharedPtr<Component> >& components = node->GetComponents();
+			for (unsigned int i = 0; i < components.Size(); ++i)
+			{
+				if (showTemporaryObject_ || !components[i]->IsTemporary())
+					return true;
+			}
+			const Vector<SharedPtr<Node> >& children = node->GetChildren();
+			for (unsigned int i = 0; i < children.Size(); ++i)
+			{
+				if (showTemporaryObject_ || !children[i]->IsTemporary())
+					return true;
+			}
+			return false;
+		}
+
+		case ITEM_UI_ELEMENT:
+		{
+			const Vector<SharedPtr<UIElement> >& children = static_cast<UIElement*>(serializable)->GetChildren();
+			for (unsigned int i = 0; i < children.Size(); ++i)
+			{
+				UIElement* childElement = children[i];
+				if ((showInternalUIElement_ || !childElement->IsInternal()) && (showTemporaryObject_ || !childElement->IsTemporary()))
+					return true;
+			}
+			return false;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	Serializable* HierarchyWindow::GetListSerializable(unsigned int itemIndex)
+	{
+		if (itemIndex >= hierarchyList_->GetNumItems())
+			return NULL;
+
+		const HierarchyListItem& item = hierarchyList_->GetItem(itemIndex);
+		switch (item.type_)
+		{
+		case ITEM_NODE:
+			return scene_ ? scene_->GetNode(item.id_) : NULL;
+
+		case ITEM_UI_ELEMENT:
+			if (mainUI_.Null())
+				return NULL;
+			if (UIUtils::GetUIElementID(mainUI_.Get()) == Variant(item.id_))
+				return mainUI_.Get();
+			return mainUI_->GetChild(UI_ELEMENT_ID_VAR, Variant(item.id_), true);
+
+		default:
+			return NULL;
+		}
+	}
+
 	void HierarchyWindow::UpdateDirtyUI()
 	{
+		ScopedStageTimer timer(this, STAGE_HIERARCHY);
+
+		bool sceneChanged = !addedNodes_.Empty() || !removedNodes_.Empty() || !addedComponents_.Empty() || !removedComponents_.Empty() ||
+			!changedNodes_.Empty();
+
+		if (scene_)
+		{
+			// Removals first, a node moved to another parent within the frame is removed and then added again
+			for (HashSet<unsigned>::ConstIterator i = removedNodes_.Begin(); i != removedNodes_.End(); ++i)
+				hierarchyList_->RemoveItem(hierarchyList_->FindItem(ITEM_NODE, *i));
+			for (HashSet<unsigned>::ConstIterator i = removedComponents_.Begin(); i != removedComponents_.End(); ++i)
+				hierarchyList_->RemoveItem(hierarchyList_->FindItem(ITEM_COMPONENT, *i));
+
+			// In event order, so that siblings keep their order. Nodes inside an added subtree come with it
+			for (HashSet<unsigned>::ConstIterator i = addedNodes_.Begin(); i != addedNodes_.End(); ++i)
+			{
+				Node* node = scene_->GetNode(*i);
+				if (node != NULL && !IsInAddedSubtree(node->GetParent()))
+					UpdateHierarchyItem(node);
+			}
+			for (HashSet<unsigned>::ConstIterator i = addedComponents_.Begin(); i != addedComponents_.End(); ++i)
+			{
+				Component* component = scene_->GetComponent(*i);
+				if (component != NULL && component->GetNode() != NULL && !IsInAddedSubtree(component->GetNode()) && GetComponentListIndex(component) == NO_ITEM)
+					UpdateComponentItem(component);
+			}
+
+			for (HashSet<unsigned>::ConstIterator i = changedNodes_.Begin(); i != changedNodes_.End(); ++i)
+			{
+				Node* node = scene_->GetNode(*i);
+				if (node != NULL)
+					UpdateHierarchyItemText(GetListIndex(node), node->IsEnabled(), UIUtils::GetNodeTitle(node));
+			}
+			for (HashSet<unsigned>::ConstIterator i = changedComponents_.Begin(); i != changedComponents_.End(); ++i)
+			{
+				Component* component = scene_->GetComponent(*i);
+				if (component != NULL)
+					UpdateHierarchyItemText(GetComponentListIndex(component), component->IsEnabledEffective());
+			}
+		}
+		ClearSceneChanges();
+
+		// New and renamed nodes may match the search
+		if (sceneChanged && hierarchyList_->IsFiltered())
+			ApplySearch();
+
 		// Perform hierarchy selection latently after the new selections are finalized (used in undo/redo action)
 		if (!hierarchyUpdateSelections_.Empty())
 		{
@@ -552,40 +737,60 @@ namespace Urho3D
 		}
 	}
 
-	void HierarchyWindow::SetID(Text* text, Serializable* serializable, int itemType /*= ITEM_NONE*/)
+	void HierarchyWindow::ClearSceneChanges()
 	{
-		// If item type is not provided, auto detect it
-		if (itemType == ITEM_NONE)
-			itemType = UIUtils::GetType(serializable);
+		addedNodes_.Clear();
+		removedNodes_.Clear();
+		addedComponents_.Clear();
+		removedComponents_.Clear();
+		changedNodes_.Clear();
+		changedComponents_.Clear();
+	}
 
-		text->SetVar(TYPE_VAR, Variant(itemType));
+	bool HierarchyWindow::IsInAddedSubtree(Node* node) const
+	{
+		for (; node != NULL; node = node->GetParent())
+		{
+			if (addedNodes_.Contains(node->GetID()))
+				return true;
+		}
 
-		text->SetVar(ID_VARS[itemType], UIUtils::GetID(serializable, itemType));
+		return false;
+	}
 
-		// Set node ID as drag and drop content for node ID editing
-		if (itemType == ITEM_NODE)
-			text->SetVar(DRAGDROPCONTENT_VAR, String(text->GetVar(NODE_ID_VAR).GetUInt()));
+	void HierarchyWindow::UpdateComponentItem(Component* component)
+	{
+		// Insert the newly added component at last component position but before the first child node position of the parent node
+		Node* node = component->GetNode();
+		unsigned int nodeIndex = GetListIndex(node);
+		if (nodeIndex == NO_ITEM)
+			return;
 
-		switch (itemType)
+		if (!hierarchyList_->IsPopulated(nodeIndex))
 		{
-		case ITEM_COMPONENT:
-			text->SetVar(NODE_ID_VAR, static_cast<Component*>(serializable)->GetNode()->GetID());
-			break;
+			// Inserted with the other child items when the node is first expanded
+			hierarchyList_->SetItemHasChildren(nodeIndex, true);
+			return;
+		}
 
-		case ITEM_UI_ELEMENT:
-			// Subscribe to UI-element events
-			SubscribeToEvent(serializable, E_NAMECHANGED, HANDLER(HierarchyWindow, HandleUIElementNameChanged));
-			SubscribeToEvent(serializable, E_VISIBLECHANGED, HANDLER(HierarchyWindow, HandleUIElementVisibilityChanged));
-			SubscribeToEvent(serializable, E_RESIZED, HANDLER(HierarchyWindow, HandleUIElementAttributeChanged));
-			SubscribeToEvent(serializable, E_POSITIONED, HANDLER(HierarchyWindow, HandleUIElementAttributeChanged));
-			break;
+		unsigned int index = NO_ITEM;
+		for (unsigned int i = 0; i < node->GetNumChildren() && index == NO_ITEM; ++i)
+			index = GetListIndex(node->GetChildren()[i]);
+		if (index == NO_ITEM)
+			index = hierarchyList_->GetChildrenEnd(nodeIndex);
+		UpdateHierarchyItem(index, component, nodeIndex);
+	}
 
-		default:
-			break;
-		}
+	void HierarchyWindow::HandleUpdate(StringHash eventType, VariantMap& eventData)
+	{
+		UpdateDirtyUI();
 	}
+
 	void HierarchyWindow::SetScene(Scene* scene)
 	{
+		// Queued changes refer to the old scene, the new one is inserted whole
+		ClearSceneChanges();
+		searchIndex_.Build(scene);
 		if (scene != NULL)
 		{
 			UpdateHierarchyItem(scene);
@@ -607,9 +812,10 @@ namespace Urho3D
 			UnsubscribeFromEvent(scene_, E_NODEENABLEDCHANGED);
 			UnsubscribeFromEvent(scene_, E_COMPONENTENABLEDCHANGED);
 			unsigned int index = GetListIndex(scene_);
-			UpdateHierarchyItem(index, NULL, NULL);
+			UpdateHierarchyItem(index, NULL, NO_ITEM);
 		}
 		scene_ = scene;
+		ApplySearch();
 	}
 
 	void HierarchyWindow::SetUIElement(UIElement* rootui)
@@ -639,7 +845,7 @@ namespace Urho3D
 			UnsubscribeFromEvent(mainUI_, E_RESIZED);
 			UnsubscribeFromEvent(mainUI_, E_POSITIONED);
 			unsigned int index = GetListIndex(mainUI_);
-			UpdateHierarchyItem(index, NULL, NULL);
+			UpdateHierarchyItem(index, NULL, NO_ITEM);
 		}
 		mainUI_ = rootui;
 	}
@@ -647,6 +853,7 @@ namespace Urho3D
 	void HierarchyWindow::SetIconStyle(XMLFile* iconstyle)
 	{
 		iconStyle_ = iconstyle;
+		hierarchyList_->SetIconStyle(iconstyle);
 	}
 
 	const String& HierarchyWindow::GetTitle()
@@ -660,16 +867,112 @@ namespace Urho3D
 			return NO_ITEM;
 
 		int itemType = UIUtils::GetType(serializable);
-		Variant id = UIUtils::GetID(serializable, itemType);
+		if (itemType == ITEM_NONE)
+			return NO_ITEM;
+
+		return hierarchyList_->FindItem(itemType, UIUtils::GetID(serializable, itemType));
+	}
+
+	unsigned int HierarchyWindow::RevealItem(Serializable* serializable, bool expand)
+	{
+		if (serializable == NULL)
+			return NO_ITEM;
+
+		PODVector<Serializable*> ancestors;
+		for (Serializable* ancestor = GetParentSerializable(serializable); ancestor != NULL; ancestor = GetParentSerializable(ancestor))
+			ancestors.Push(ancestor);
+
+		// From the top down, each ancestor populated inserts the next one's item
+		for (unsigned int i = ancestors.Size(); i-- > 0;)
+		{
+			unsigned int index = GetListIndex(ancestors[i]);
+			if (index == NO_ITEM)
+				continue;
+			if (expand)
+				hierarchyList_->Expand(index, true);
+			else
+				hierarchyList_->Populate(index);
+		}
+
+		return GetListIndex(serializable);
+	}
+
+	void HierarchyWindow::RevealItems(const PODVector<Serializable*>& serializables, bool expand)
+	{
+		// Collect the parents by depth. Nothing is inserted yet, so the list index is refreshed at most once
+		Vector<PODVector<Serializable*> > levels;
+		HashSet<Serializable*> ancestorSet;
+		PODVector<Serializable*> ancestors;
+		for (unsigned i = 0; i < serializables.Size(); ++i)
+		{
+			ancestors.Clear();
+			for (Serializable* ancestor = GetParentSerializable(serializables[i]); ancestor != NULL; ancestor = GetParentSerializable(ancestor))
+				ancestors.Push(ancestor);
+			if (levels.Size() < ancestors.Size())
+				levels.Resize(ancestors.Size());
+			// Bottom up, the ancestors of one already collected are too
+			for (unsigned j = 0; j < ancestors.Size() && !ancestorSet.Contains(ancestors[j]); ++j)
+			{
+				ancestorSet.Insert(ancestors[j]);
+				levels[ancestors.Size() - 1 - j].Push(ancestors[j]);
+			}
+		}
+
+		// Populate level by level from the top, each level from the last item up so that populating only moves the items already done.
+		// The index is refreshed once per level instead of once per item
+		PODVector<unsigned> indices;
+		for (unsigned i = 0; i < levels.Size(); ++i)
+		{
+			indices.Clear();
+			for (unsigned j = 0; j < levels[i].Size(); ++j)
+			{
+				unsigned index = GetListIndex(levels[i][j]);
+				if (index != NO_ITEM && (expand || !hierarchyList_->IsPopulated(index)))
+					indices.Push(index);
+			}
+			Sort(indices.Begin(), indices.End());
+			for (unsigned j = indices.Size(); j-- > 0;)
+			{
+				if (expand)
+					hierarchyList_->Expand(indices[j], true);
+				else
+					hierarchyList_->Populate(indices[j]);
+			}
+		}
+	}
+
+	void HierarchyWindow::ApplySearch()
+	{
+		if (scene_.Null() || searchQuery_.Trimmed().Empty())
+		{
+			hierarchyList_->ClearFilter();
+			return;
+		}
+
+		PODVector<unsigned> nodeIDs;
+		searchIndex_.Query(searchQuery_, nodeIDs);
+		if (nodeIDs.Size() > MAX_SEARCH_RESULTS)
+			nodeIDs.Resize(MAX_SEARCH_RESULTS);
 
-		unsigned int numItems = hierarchyList_->GetNumItems();
-		for (unsigned int i = 0; i < numItems; ++i)
+		// Only the unlisted matches need their parents populated
+		PODVector<Serializable*> unlisted;
+		for (unsigned i = 0; i < nodeIDs.Size(); ++i)
 		{
-			if (UIUtils::MatchID(hierarchyList_->GetItem(i), id, itemType))
-				return i;
+			Node* node = scene_->GetNode(nodeIDs[i]);
+			if (node != NULL && GetListIndex(node) == NO_ITEM)
+				unlisted.Push(node);
 		}
+		RevealItems(unlisted, false);
 
-		return NO_ITEM;
+		// Temporary nodes have no item unless shown
+		PODVector<unsigned> indices;
+		for (unsigned i = 0; i < nodeIDs.Size(); ++i)
+		{
+			unsigned index = hierarchyList_->FindItem(ITEM_NODE, nodeIDs[i]);
+			if (index != NO_ITEM)
+				indices.Push(index);
+		}
+		hierarchyList_->SetFilter(indices);
 	}
 
 	unsigned int HierarchyWindow::GetComponentListIndex(Component* component)
@@ -677,15 +980,73 @@ namespace Urho3D
 		if (component == NULL)
 			return NO_ITEM;
 
-		unsigned int numItems = hierarchyList_->GetNumItems();
-		for (unsigned int i = 0; i < numItems; ++i)
+		return hierarchyList_->FindItem(ITEM_COMPONENT, component->GetID());
+	}
+
+	void HierarchyWindow::Benchmark(unsigned maxNodes)
+	{
+		// Generated scenes go through the same rebuild and lookups as a loaded one, in a list of their own so that the shown list
+		// keeps its expanded items, selection and search filter
+		SharedPtr<HierarchyList> shownList = hierarchyList_;
+		hierarchyList_ = new HierarchyList(context_);
+		SubscribeToEvent(hierarchyList_, E_HIERARCHYLISTPOPULATE, HANDLER(HierarchyWindow, HandleHierarchyListPopulate));
+		// Expanding looks nodes up in the scene being shown
+		WeakPtr<Scene> editScene = scene_;
+
+		for (unsigned numNodes = 1000; numNodes <= maxNodes; numNodes *= 2)
 		{
-			UIElement* item = hierarchyList_->GetItems()[i];
-			if (item->GetVar(TYPE_VAR).GetInt() == ITEM_COMPONENT && item->GetVar(COMPONENT_ID_VAR).GetUInt() == component->GetID())
-				return i;
+			SharedPtr<Scene> scene(new Scene(context_));
+			PODVector<Node*> nodes;
+			// Groups of ten so that items are inserted under parents at two depths
+			for (unsigned i = 0; i < numNodes / 10; ++i)
+			{
+				Node* group = scene->CreateChild("Group" + String(i));
+				nodes.Push(group);
+				for (unsigned j = 0; j < 9; ++j)
+					nodes.Push(group->CreateChild("Node"));
+			}
+
+			scene_ = scene;
+
+			HiresTimer timer;
+			UpdateHierarchyItem(hierarchyList_->GetNumItems(), scene, NO_ITEM);
+			long long rebuildTime = timer.GetUSec(true);
+			unsigned numOpenItems = hierarchyList_->GetNumItems();
+
+			// Populate every item as the expand all button does
+			hierarchyList_->Expand(0, true, true);
+			long long expandTime = timer.GetUSec(true);
+
+			unsigned found = 0;
+			for (unsigned i = 0; i < nodes.Size(); ++i)
+			{
+				if (GetListIndex(nodes[i]) != NO_ITEM)
+					++found;
+			}
+			long long lookupTime = timer.GetUSec(true);
+
+			unsigned numItems = hierarchyList_->GetNumItems();
+			LOGINFOF("Hierarchy benchmark: %u items, open %.2f ms (%u items), expand all %.2f ms (%.2f us/item), lookup %.3f us/item, %u of %u found",
+				numItems, rebuildTime / 1000.0f, numOpenItems, expandTime / 1000.0f, (float)expandTime / numItems, (float)lookupTime / nodes.Size(),
+				found, nodes.Size());
+
+			// Matches Group1 and Group10 on up, like a partly typed name
+			HierarchySearchIndex searchIndex;
+			timer.Reset();
+			searchIndex.Build(scene);
+			long long indexTime = timer.GetUSec(true);
+			PODVector<unsigned> matches;
+			searchIndex.Query("group1", matches);
+			long long queryTime = timer.GetUSec(true);
+			LOGINFOF("Hierarchy search benchmark: %u nodes, index %.2f ms, query %.3f ms (%u matches)", searchIndex.GetNumNodes(),
+				indexTime / 1000.0f, queryTime / 1000.0f, matches.Size());
+
+			ClearListView();
 		}
 
-		return NO_ITEM;
+		UnsubscribeFromEvent(hierarchyList_, E_HIERARCHYLISTPOPULATE);
+		hierarchyList_ = shownList;
+		scene_ = editScene;
 	}
 
 	Scene* HierarchyWindow::GetScene()
@@ -703,7 +1064,7 @@ namespace Urho3D
 		return iconStyle_;
 	}
 
-	ListView* HierarchyWindow::GetHierarchyList()
+	HierarchyList* HierarchyWindow::GetHierarchyList()
 	{
 		return hierarchyList_;
 	}
@@ -713,21 +1074,14 @@ namespace Urho3D
 		return titleBar_;
 	}
 
-	void HierarchyWindow::AddComponentItem(unsigned int compItemIndex, Component* component, UIElement* parentItem)
+	unsigned int HierarchyWindow::AddComponentItem(unsigned int compItemIndex, Component* component, unsigned int parentIndex)
 	{
-		Text* text = new Text(context_);
-		hierarchyList_->InsertItem(compItemIndex, text, parentItem);
-		text->SetStyle("FileSelectorListText");
-		text->SetVar(TYPE_VAR, ITEM_COMPONENT);
-		text->SetVar(NODE_ID_VAR, component->GetNode()->GetID());
-		text->SetVar(COMPONENT_ID_VAR, component->GetID());
-		text->SetText(UIUtils::GetComponentTitle(component));
-		text->SetColor(componentTextColor_);
+		HierarchyListItem item;
+		item.type_ = ITEM_COMPONENT;
+		item.id_ = component->GetID();
+		item.enabled_ = component->IsEnabledEffective();
 		// Components currently act only as drag targets
-		text->SetDragDropMode(DD_TARGET);
-		if (iconStyle_)
-			UIUtils::IconizeUIElement(context_, iconStyle_, text, component->GetTypeName());
-		UIUtils::SetIconEnabledColor(text, component->IsEnabledEffective());
+		item.dragDropMode_ = DD_TARGET;
+		return hierarchyList_->InsertItem(compItemIndex, parentIndex, item, UIUtils::GetComponentTitle(component), component->GetTypeName()) + 1;
 	}
 }
-
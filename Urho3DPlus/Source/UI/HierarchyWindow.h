@@ -4,16 +4,20 @@
 #include "../Urho3D.h"
 #include "../UI/Window.h"
 #include "../Core/Context.h"
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
 #include "Utils/Macros.h"
 #include "UIGlobals.h"
+#include "HierarchySearchIndex.h"
 
 
 namespace Urho3D
 {
 	class Text;
 	class Button;
-	class ListView;
+	class HierarchyList;
 	class CheckBox;
+	class LineEdit;
 	class UIElement;
 	class Component;
 	class Node;
@@ -44,15 +48,21 @@ namespace Urho3D
 		void SetScene(Scene* scene);
 		void SetUIElement(UIElement* rootui);
 		void SetIconStyle(XMLFile* iconstyle);
+		/// Build generated scenes of doubling size up to maxNodes in a separate list and log the open, expand all, lookup and search times. The shown list is left untouched.
+		void Benchmark(unsigned maxNodes = 64000);
 
 		/// Getters
 		const String&	GetTitle();
 		unsigned int	GetListIndex(Serializable* serializable);
 		unsigned int	GetComponentListIndex(Component* component);
+		/// Populate and optionally expand the parent chain of a node, component or UI element. Return its list index, or NO_ITEM.
+		unsigned int	RevealItem(Serializable* serializable, bool expand = true);
+		/// Populate and optionally expand the parent chains of many items at once, refreshing the list index once per depth level rather than once per item.
+		void			RevealItems(const PODVector<Serializable*>& serializables, bool expand = true);
 		Scene*			GetScene();
 		UIElement*		GetUIElement();
 		XMLFile*		GetIconStyle();
-		ListView*		GetHierarchyList();
+		HierarchyList*	GetHierarchyList();
 		UIElement*		GetTitleBar();
 		// Serializable Attributes
 		U_PROPERTY_IMP_PASS_BY_REF(Color,normalTextColor_,NormalTextColor)
@@ -68,22 +78,40 @@ namespace Urho3D
 	protected:
 		void ClearListView();
 		bool TestDragDrop(UIElement* source, UIElement* target, int& itemType);
-		void SetID(Text* text, Serializable* serializable, int itemType = ITEM_NONE);
-		void AddComponentItem(unsigned int compItemIndex, Component* component, UIElement* parentItem);
+		/// Insert a component item. Return the index after it.
+		unsigned int AddComponentItem(unsigned int compItemIndex, Component* component, unsigned int parentIndex);
+		/// Insert the child items of an item. Return the index after them.
+		unsigned int AddChildItems(unsigned int parentIndex, Serializable* serializable);
+		/// Return whether a node or UI element has child items to show.
+		bool HasChildItems(Serializable* serializable);
+		/// Return the node or UI element of a list item.
+		Serializable* GetListSerializable(unsigned int itemIndex);
 
 		/// Update 
-		unsigned int	UpdateHierarchyItem(unsigned int itemIndex, Serializable* serializable, UIElement* parentItem);
+		unsigned int	UpdateHierarchyItem(unsigned int itemIndex, Serializable* serializable, unsigned int parentIndex);
 		void			UpdateHierarchyItemText(unsigned int itemIndex, bool iconEnabled, const String& textTitle = NO_CHANGE);
+		/// Apply the scene changes queued since the last call and the pending selection. Called once per frame.
 		void			UpdateDirtyUI();
+		/// Filter the list to the nodes matching the search query and their parents.
+		void			ApplySearch();
+		/// Drop the queued scene changes.
+		void			ClearSceneChanges();
+		/// Return whether a node or one of its parents was added since the last UpdateDirtyUI().
+		bool			IsInAddedSubtree(Node* node) const;
+		/// Insert a component added to a node already in the list.
+		void			UpdateComponentItem(Component* component);
 
 		/// UI actions
 		void HideHierarchyWindow(StringHash eventType, VariantMap& eventData);
 		void ExpandCollapseHierarchy(StringHash eventType, VariantMap& eventData);
 		void HandleHierarchyListSelectionChange(StringHash eventType, VariantMap& eventData);
 		void HandleHierarchyListDoubleClick(StringHash eventType, VariantMap& eventData);
+		void HandleHierarchyListPopulate(StringHash eventType, VariantMap& eventData);
+		void HandleSearchTextChanged(StringHash eventType, VariantMap& eventData);
 		void HandleDragDropTest(StringHash eventType, VariantMap& eventData);
 		void HandleDragDropFinish(StringHash eventType, VariantMap& eventData);
 		void HandleTemporaryChanged(StringHash eventType, VariantMap& eventData);
+		void HandleUpdate(StringHash eventType, VariantMap& eventData);
 
 		/// Scene Events
 		void HandleNodeAdded(StringHash eventType, VariantMap& eventData);
@@ -107,7 +135,8 @@ namespace Urho3D
 		SharedPtr<Button>	expandButton_;
 		SharedPtr<Button>	collapseButton_;
 		SharedPtr<CheckBox> allCheckBox_;
-		SharedPtr<ListView> hierarchyList_;
+		SharedPtr<LineEdit> searchEdit_;
+		SharedPtr<HierarchyList> hierarchyList_;
 		SharedPtr<UIElement>	titleBar_;
 		SharedPtr<BorderImage>	img_;
 		// Serializable Attributes
@@ -117,6 +146,16 @@ namespace Urho3D
 		/// \todo use weakptr
 		WeakPtr<Scene> scene_;
 		WeakPtr<UIElement> mainUI_;
+		/// Scene changes queued by the scene event handlers, by node or component ID. Applied together once per frame.
+		HashSet<unsigned> addedNodes_;
+		HashSet<unsigned> removedNodes_;
+		HashSet<unsigned> addedComponents_;
+		HashSet<unsigned> removedComponents_;
+		HashSet<unsigned> changedNodes_;
+		HashSet<unsigned> changedComponents_;
+		/// Node names and component types of the scene.
+		HierarchySearchIndex searchIndex_;
+		String searchQuery_;
 
 	};
 }
@@ -51,6 +51,16 @@ namespace Urho3D
 
 	const StringHash A_CREATECOMPONENT_VAR("CreateComponent");
 	const StringHash A_CREATEBUILTINOBJ_VAR("CreateBuiltinObject");
+	const StringHash A_BENCHMARKPICKING_VAR("BenchmarkPicking");
+	const StringHash A_BENCHMARKHIERARCHY_VAR("BenchmarkHierarchy");
+	const StringHash A_RENDERONDEMAND_VAR("RenderOnDemand");
+	const StringHash A_EXPORTFRAMETIMES_VAR("ExportFrameTimes");
+	const StringHash A_DYNAMICRESOLUTION_VAR("DynamicResolution");
+	const StringHash A_VIEWLAYOUTSINGLE_VAR("ViewLayoutSingle");
+	const StringHash A_VIEWLAYOUTSPLIT_VAR("ViewLayoutSplit");
+	const StringHash A_VIEWLAYOUTQUAD_VAR("ViewLayoutQuad");
+	const StringHash A_INACTIVEVIEWRATE_VAR("InactiveViewRate");
+	const StringHash A_GIZMOPREVIEW_VAR("GizmoPreview");
 	
 	const int PICK_GEOMETRIES = 0;
 	const int PICK_LIGHTS = 1;
@@ -0,0 +1,32 @@
+#include "../Urho3D.h"
+#include "../Core/Context.h"
+#include "StageTimer.h"
+
+namespace Urho3D
+{
+	ScopedStageTimer* ScopedStageTimer::current_ = 0;
+
+	ScopedStageTimer::ScopedStageTimer(Object* sender, EditorStage stage) :
+		sender_(sender),
+		stage_(stage),
+		parent_(current_),
+		nestedTime_(0)
+	{
+		current_ = this;
+	}
+
+	ScopedStageTimer::~ScopedStageTimer()
+	{
+		long long elapsed = timer_.GetUSec(false);
+		current_ = parent_;
+		if (parent_)
+			parent_->nestedTime_ += elapsed;
+
+		using namespace EditorStageTime;
+
+		VariantMap& eventData = sender_->GetEventDataMap();
+		eventData[P_STAGE] = (int)stage_;
+		eventData[P_TIME] = elapsed > nestedTime_ ? (unsigned)(elapsed - nestedTime_) : 0;
+		sender_->SendEvent(E_EDITORSTAGETIME, eventData);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+
+namespace Urho3D
+{
+	/// Editor work measured per frame.
+	enum EditorStage
+	{
+		STAGE_GIZMO = 0,
+		STAGE_HOVERRAYCAST,
+		STAGE_DEBUGDRAW,
+		STAGE_HIERARCHY,
+		STAGE_INSPECTOR,
+		STAGE_SCENEUPDATE,
+		MAX_EDITOR_STAGES
+	};
+
+	/// Time spent in an editor stage, not counting the stages timed inside it.
+	EVENT(E_EDITORSTAGETIME, EditorStageTime)
+	{
+		PARAM(P_STAGE, Stage);                // int
+		PARAM(P_TIME, Time);                  // unsigned, microseconds
+	}
+
+	/// Sends the time of its own lifetime as E_EDITORSTAGETIME. Time of timers nested inside it is left to them, so stages never count twice. Main thread only.
+	class ScopedStageTimer
+	{
+	public:
+		/// Construct and start timing.
+		ScopedStageTimer(Object* sender, EditorStage stage);
+		/// Destruct and send the elapsed time.
+		~ScopedStageTimer();
+
+	private:
+		/// Event sender.
+		Object* sender_;
+		/// Stage.
+		EditorStage stage_;
+		/// Enclosing timer.
+		ScopedStageTimer* parent_;
+		/// Time of the timers nested inside this one, in microseconds.
+		long long nestedTime_;
+		/// Timer.
+		HiresTimer timer_;
+
+		/// Innermost running timer.
+		static ScopedStageTimer* current_;
+	};
+}